@@ -55,6 +55,9 @@
 //#define NO_TIMEOUTS
 // Uncomment to include more info in ok command
 //#define ADVANCED_OK
+// Uncomment to send "ok" as soon as a line is queued instead of after it is executed,
+// so the host can keep the command queue full. Best used with ADVANCED_OK.
+//#define EARLY_OK
 /***********************************************************************/
 
 
@@ -612,6 +612,21 @@
 /**************************************************************************/
 
 
+/**************************************************************************
+ ************************* Endstop interrupts *****************************
+ **************************************************************************
+ *                                                                        *
+ * Endstop pins raise an interrupt when they change, and the stepper ISR  *
+ * reads them only after a change or while one of them is triggered,      *
+ * instead of at every step.                                              *
+ * Every endstop pin needs an external or pin change interrupt, pins      *
+ * without one make the stepper read the endstops as before.              *
+ *                                                                        *
+ **************************************************************************/
+//#define ENDSTOP_INTERRUPTS_FEATURE
+/**************************************************************************/
+
+
 /**************************************************************************
  ******************** Abort on endstop hit feature ************************
  **************************************************************************
@@ -689,6 +704,75 @@
 /***********************************************************************/
 
 
+/***********************************************************************
+ ************************** Planner dwell ******************************
+ ***********************************************************************
+ *                                                                     *
+ * G4 queues a dwell block instead of waiting for the moves to finish. *
+ * The machine stops for the dwell in sequence with the moves, the     *
+ * laser keeps its M3/M4 state (pierce), and the following commands    *
+ * are planned during the dwell. G4 P0 still waits for all moves.      *
+ *                                                                     *
+ * Uncomment PLANNER_DWELL to enable this feature                      *
+ *                                                                     *
+ ***********************************************************************/
+//#define PLANNER_DWELL
+/***********************************************************************/
+
+
+/***********************************************************************
+ *********************** Real time overrides ***************************
+ ***********************************************************************
+ *                                                                     *
+ * A feed override (M220 or LCD) replans the moves already in the      *
+ * buffer, it acts when the running move ends instead of after the     *
+ * whole buffer. With a laser M649 O<percent> scales the power of the  *
+ * running move at once.                                               *
+ *                                                                     *
+ * Uncomment REALTIME_OVERRIDES to enable this feature                 *
+ *                                                                     *
+ ***********************************************************************/
+//#define REALTIME_OVERRIDES
+/***********************************************************************/
+
+
+/***********************************************************************
+ ***************************** Feed hold *******************************
+ ***********************************************************************
+ *                                                                     *
+ * M25 and the LCD pause stop the axes in the middle of the running    *
+ * move at the planned acceleration instead of after the moves in the  *
+ * buffer. The laser goes off at the step where the axes stop and the  *
+ * moves left in the buffer are kept. M24 or the LCD resume goes on    *
+ * from there, accelerating from rest. With a full planner buffer a    *
+ * serial M24 is queued behind the held moves, so FEED_HOLD requires   *
+ * an LCD (ULTIPANEL) or REALTIME_COMMANDS to resume.                  *
+ *                                                                     *
+ * Uncomment FEED_HOLD to enable this feature                          *
+ *                                                                     *
+ ***********************************************************************/
+//#define FEED_HOLD
+/***********************************************************************/
+
+
+/***********************************************************************
+ ************************ S-curve acceleration *************************
+ ***********************************************************************
+ *                                                                     *
+ * Speed changes follow an S-curve instead of a straight line, so the  *
+ * acceleration builds up and fades out smoothly and the gantry rings  *
+ * less at the start and end of every ramp. A ramp takes the same time *
+ * and distance as with the linear profile, at 1.5 times the set       *
+ * acceleration in its middle, so lower the acceleration by up to a    *
+ * third if the motors lose steps.                                     *
+ *                                                                     *
+ * Uncomment S_CURVE_ACCELERATION to enable this feature               *
+ *                                                                     *
+ ***********************************************************************/
+//#define S_CURVE_ACCELERATION
+/***********************************************************************/
+
+
 /***********************************************************************
  *************************** Quick home ********************************
  ***********************************************************************
@@ -1044,6 +1128,23 @@
 //#define SD_CHECK_AND_RETRY  // Use CRC checks and retries on the SD communication
 //#define SD_EXTENDED_DIR     // Show extended directory including file length. Don't use this with Pronterface
 
+// Binary upload with "M28 B1 filename": CRC checked blocks written in whole sectors.
+// Use scripts/sd_bulk_upload.py on the host side.
+//#define SD_BULK_UPLOAD
+#define SD_BULK_BLOCK_SIZE  256   // Max data bytes per block, must divide 512
+#define SD_BULK_WINDOW        3   // Max blocks in flight, WINDOW * (BLOCK_SIZE + 6) must fit the RX buffer
+#define SD_BULK_RX_BUFFER  1024   // Serial RX buffer size with SD_BULK_UPLOAD (128 without), a power of 2
+#define SD_BULK_TIMEOUT    5000   // (ms) Abort the upload if the host is silent for this long
+
+// Power loss journal: while printing from SD a checkpoint of the last completed move
+// (file position, XYZ, feedrate, laser mode and power) is written to an EEPROM ring
+// at most every POWER_LOSS_JOURNAL_INTERVAL, one byte per idle() call so the job never waits.
+// After a power loss home the machine and use M413 R to continue the job.
+//#define POWER_LOSS_JOURNAL
+#define POWER_LOSS_JOURNAL_INTERVAL 30000 // (ms) Minimum time between two checkpoints
+#define POWER_LOSS_JOURNAL_SLOTS      16  // Records in the ring, each slot is rewritten every INTERVAL * SLOTS:
+                                          // 100000 EEPROM cycles last about 13000 job hours with the defaults
+
 // Decomment this if you are external SD without DETECT_PIN
 //#define SD_DISABLED_DETECT
 // Some RAMPS and other boards don't detect when an SD card is inserted. You can work
@@ -1307,6 +1408,21 @@
 /***********************************************************************/
 
 
+/***********************************************************************
+ ************************ Step port batching ***************************
+ ***********************************************************************
+ *                                                                     *
+ * The X, Y and Z step pins that are on the same port as X_STEP_PIN    *
+ * are pulsed together with a single write to the port per edge.      *
+ * Not available with dual stepper drivers or DUAL_X_CARRIAGE.         *
+ *                                                                     *
+ * Uncomment STEP_PORT_BATCHING to enable this feature                 *
+ *                                                                     *
+ ***********************************************************************/
+//#define STEP_PORT_BATCHING
+/***********************************************************************/
+
+
 /***********************************************************************
  ************************* High speed stepper **************************
  ***********************************************************************
@@ -1543,6 +1659,68 @@
 /****************************************************************************************/
 
 
+/*****************************************************************************************
+ ********************************* Idle task scheduler ***********************************
+ *****************************************************************************************
+ *                                                                                       *
+ * idle() is called from every busy-wait (planner full, st_synchronize, dwell...).       *
+ * Without this feature it runs heater, inactivity and LCD managers on every call.       *
+ * With this feature every task has a period, a time budget and a deadline, and when     *
+ * the planner holds less than IDLE_PLANNER_WATERMARK moves the command queue is         *
+ * refilled first and only the tasks fitting in IDLE_TASK_SLICE (or late ones) are run.  *
+ *                                                                                       *
+ * Uncomment IDLE_TASK_SCHEDULER to enable this feature                                  *
+ *                                                                                       *
+ *****************************************************************************************/
+//#define IDLE_TASK_SCHEDULER
+#define IDLE_PLANNER_WATERMARK  4     // Planned moves under which refilling the queue has precedence
+#define IDLE_TASK_SLICE      1000     // (us) Time given to the periodic tasks for each idle() while the planner is hungry
+/*****************************************************************************************/
+
+
+/*****************************************************************************************
+ ********************************* Status auto-report ************************************
+ *****************************************************************************************
+ *                                                                                       *
+ * M155 S<seconds> makes the firmware send a status line with temperatures, position,   *
+ * laser state and queue depth every S seconds, so the host doesn't need to poll with    *
+ * M105 and M114. M155 S0 stops it.                                                      *
+ *                                                                                       *
+ * Uncomment AUTO_REPORT_STATUS to enable this feature                                   *
+ *                                                                                       *
+ *****************************************************************************************/
+//#define AUTO_REPORT_STATUS
+/*****************************************************************************************/
+
+
+/*****************************************************************************************
+ ********************************** Real-time commands ***********************************
+ *****************************************************************************************
+ *                                                                                       *
+ * Single bytes from the host that skip the command queue. The serial RX interrupt       *
+ * takes them out of the stream and idle() serves them, also when the queue waits on     *
+ * a full planner buffer:                                                                *
+ *   RT_STATUS_CHAR      send a status line like M155                                    *
+ *   RT_FEED_HOLD_CHAR   feed hold, like M25 (FEED_HOLD)                                 *
+ *   RT_RESUME_CHAR      resume the held moves and a paused SD job (FEED_HOLD)           *
+ *   RT_LASER_KILL_CHAR  beam off at once, drop the planned moves and stop, M999 to      *
+ *                       restart                                                         *
+ * The printable ones count only at the start of a line, Ctrl-X anywhere. A laser kill   *
+ * stops the stepper ISR from firing before idle() gets to it.                           *
+ * Binary SD uploads (M28 B1) are passed through untouched.                              *
+ *                                                                                       *
+ * Uncomment REALTIME_COMMANDS to enable this feature                                    *
+ *                                                                                       *
+ *****************************************************************************************/
+//#define REALTIME_COMMANDS
+#define RT_STATUS_CHAR      '?'
+#define RT_FEED_HOLD_CHAR   '!'
+#define RT_RESUME_CHAR      '~'
+#define RT_LASER_KILL_CHAR  0x18  // Ctrl-X
+/*****************************************************************************************/
+
+
+
 /*****************************************************************************************
  ************************************* JSON OUTPUT ***************************************
  *****************************************************************************************
@@ -36,6 +36,30 @@
 #define LASER_RASTER_ASPECT_RATIO 1 // pixels aren't square on most displays, 1.33 == 4:3 aspect ratio. 
 #define LASER_RASTER_MM_PER_PULSE 0.2 //Can be overridden by providing an R value in M649 command : M649 S17 B2 D0 R0.1 F4000
 
+//// Keep track of the last raster line an SD job completed and save it to EEPROM when the
+//// machine is stopped or killed. After homing, M654 R continues the job from the next line.
+//#define LASER_RASTER_RESUME
+
+//// Multipass cutting: M660 records the following moves in RAM, M661 S<passes> Z<step> replays them
+//// without sending the G-code again. Arcs are recorded per segment, raster lines and G4 dwells can't be recorded.
+//#define LASER_MULTIPASS
+#define LASER_MULTIPASS_MOVES 48 // moves kept in RAM, 26 bytes each, 28 with LASER_POWER_RAMP
+
+//// Sample the POWER_CONSUMPTION sensor while the laser fires and keep a histogram of the tube current
+//// per commanded intensity range. M652 prints it, M652 R clears it.
+//// Needs POWER_CONSUMPTION with the sensor in series with the laser power supply.
+//#define LASER_CURRENT_HISTOGRAM
+#define LASER_CURRENT_BINS 16 // intensity ranges, 6 bytes each
+
+//// Correct the open loop intensity to PWM mapping with a monotone curve stored in EEPROM.
+//// M653 S<ms> sweeps the output and measures the tube current (needs POWER_CONSUMPTION),
+//// or enter burn test results with M653 P<point> V<value> and fit them with M653 F.
+//#define LASER_POWER_CALIBRATION
+#define LASER_CAL_POINTS 11 // curve points, 0% to 100% in equal steps
+
+//// Power ramps: G1 S<start> Q<end> changes the intensity linearly along the move (continuous mode)
+//#define LASER_POWER_RAMP
+
 //// Uncomment the following if the laser cutter is equipped with a peripheral relay board
 //// to control power to an exhaust fan, water pump, laser power supply, etc.
 //#define LASER_PERIPHERALS
@@ -16,7 +16,7 @@
  *
  */
 
-#define EEPROM_VERSION "MKV429"
+#define EEPROM_VERSION "MKV430"
 
 /**
  * MKV428 EEPROM Layout:
@@ -100,6 +100,9 @@
  * ALLIGATOR:
  *  M906  XYZ T0-4 E      Motor current
  *
+ * LASER_POWER_CALIBRATION:
+ *  M653  P C             laser_cal_curve (x LASER_CAL_POINTS)
+ *
  */
 
 void _EEPROM_writeData(int& pos, uint8_t* value, uint8_t size) {
@@ -261,6 +264,10 @@ void Config_StoreSettings() {
     EEPROM_WRITE_VAR(i, motor_current);
   #endif
 
+  #if ENABLED(LASER_POWER_CALIBRATION)
+    EEPROM_WRITE_VAR(i, laser_cal_curve);
+  #endif
+
   char ver2[7] = EEPROM_VERSION;
   int j = EEPROM_OFFSET;
   EEPROM_WRITE_VAR(j, ver2); // validate data
@@ -417,6 +424,10 @@ void Config_RetrieveSettings() {
       EEPROM_READ_VAR(i, motor_current);
     #endif
 
+    #if ENABLED(LASER_POWER_CALIBRATION)
+      EEPROM_READ_VAR(i, laser_cal_curve);
+    #endif
+
     // Call updatePID (similar to when we have processed M301)
     updatePID();
 
@@ -628,6 +639,10 @@ void Config_ResetDefault() {
     IDLE_OOZING_enabled = true;
   #endif
 
+  #if ENABLED(LASER_POWER_CALIBRATION)
+    laser_cal_reset();
+  #endif
+
   ECHO_LM(DB, "Hardcoded Default Settings Loaded");
 }
 
@@ -907,6 +922,16 @@ void Config_ResetDefault() {
       #endif // DRIVER_EXTRUDERS > 1
     #endif // ALLIGATOR
 
+    #if ENABLED(LASER_POWER_CALIBRATION)
+      if (!forReplay) {
+        ECHO_LM(CFG, "Laser power calibration:");
+      }
+      for (uint8_t i = 0; i < LASER_CAL_POINTS; i++) {
+        ECHO_SMV(CFG, "  M653 P", (int)i);
+        ECHO_EMV(" C", laser_cal_curve[i]);
+      }
+    #endif
+
     ConfigSD_PrintSettings(forReplay);
 
   }
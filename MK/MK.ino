@@ -35,10 +35,10 @@
  * "G" Codes
  *
  * G0  -> G1 except for laser where G0 is "move without firing"
- * G1  - Coordinated Movement X Y Z E, for laser move by firing
+ * G1  - Coordinated Movement X Y Z E, for laser move by firing, S<start> Q<end> ramps the laser intensity along the move (LASER_POWER_RAMP)
  * G2  - CW ARC
  * G3  - CCW ARC
- * G4  - Dwell S<seconds> or P<milliseconds>
+ * G4  - Dwell S<seconds> or P<milliseconds>, queued in sequence with the moves with PLANNER_DWELL
  * G5  - Bezier curve - from http://forums.reprap.org/read.php?147,93577
  * G7  - Execute laser raster line
  * G10 - retract filament according to settings of M207
@@ -73,10 +73,10 @@
  * M22  - Release SD card
  * M23  - Select SD file (M23 filename.g)
  * M24  - Start/resume SD print
- * M25  - Pause SD print
+ * M25  - Pause SD print, with FEED_HOLD the axes stop at once and M24 resumes the held moves
  * M26  - Set SD position in bytes (M26 S12345)
  * M27  - Report SD print status
- * M28  - Start SD write (M28 filename.g)
+ * M28  - Start SD write (M28 filename.g), M28 B1 filename.g for binary block upload
  * M29  - Stop SD write
  * M30  - Delete file from SD (M30 filename.g)
  * M31  - Output time since last M109 or SD card start to serial
@@ -121,6 +121,7 @@
  * M140 - Set bed target temp
  * M145 - Set the heatup state H<hotend> B<bed> F<fan speed> for S<material> (0=PLA, 1=ABS)
  * M150 - Set BlinkM Color Output R: Red<0-255> U(!): Green<0-255> B: Blue<0-255> over i2c, G for green does not work.
+ * M155 - S<seconds> Send a status line (temperatures, position, laser, queue) every S seconds, S0 to stop. Requires AUTO_REPORT_STATUS.
  * M163 - Set a single proportion for a mixing extruder. Requires COLOR_MIXING_EXTRUDER.
  * M164 - Save the mix as a virtual extruder. Requires COLOR_MIXING_EXTRUDER and MIXING_VIRTUAL_TOOLS.
  * M165 - Set the proportions for a mixing extruder. Use parameters ABCDHI to set the mixing factors. Requires COLOR_MIXING_EXTRUDER.
@@ -137,7 +138,7 @@
  * M208 - Set recover=unretract length S[positive mm surplus to the M207 S*] F[feedrate mm/min]
  * M209 - S<1=true/0=false> enable automatic retract detect if the slicer did not support G10/11: every normal extrude-only move will be classified as retract depending on the direction.
  * M218 - Set hotend offset (in mm): T<extruder_number> X<offset_on_X> Y<offset_on_Y>
- * M220 - Set speed factor override percentage: S<factor in percent>
+ * M220 - Set speed factor override percentage: S<factor in percent>, applied to the planned moves with REALTIME_OVERRIDES
  * M221 - Set extrude factor override percentage: S<factor in percent>
  * M222 - Set density extrusion percentage for purge: S<factor in percent>
  * M226 - Wait until the specified pin reaches the state required: P<pin number> S<pin state>
@@ -162,6 +163,7 @@
  * M407 - Display measured filament diameter
  * M408 - Report JSON-style response
  * M410 - Quickstop. Abort all the planned moves
+ * M413 - Power loss journal: print the last checkpoint of the SD job, R resumes the job from it, C discards it (POWER_LOSS_JOURNAL)
  * M428 - Set the home_offset logically based on the current_position
  * M500 - Store parameters in EEPROM
  * M501 - Read parameters from EEPROM (if you need reset them after you changed them temporarily).
@@ -172,9 +174,14 @@
  * M595 - Set hotend AD595 O<offset> and S<gain>
  * M600 - Pause for filament change X[pos] Y[pos] Z[relative lift] E[initial retract] L[later retract distance for removal]
  * M605 - Set dual x-carriage movement mode: S<mode> [ X<duplication x-offset> R<duplication temp offset> ]
- * M649 - laser set options
+ * M649 - laser set options, O<percent> scales the power of the running move (REALTIME_OVERRIDES)
  * M650 - mUVe peel set peel distance
  * M651 - mUVe peel run peel move
+ * M652 - Laser current histogram from the power consumption sensor, R to clear it
+ * M653 - Laser power calibration: S<ms> sweep and measure, P<point> V<response> enter a burn result, F fit, R reset
+ * M654 - Print the saved raster job progress, R resumes the job after its last completed line (LASER_RASTER_RESUME)
+ * M660 - Laser multipass: record the next N<moves> moves
+ * M661 - Laser multipass: replay the recorded moves S<passes> times, Z<mm> change before every pass
  * M666 - Set z probe offset or Endstop and delta geometry adjustment
  * M906 - Set motor currents XYZ T0-4 E
  * M907 - Set digital trimpot motor current using axis codes.
@@ -29,7 +29,33 @@
     ring_buffer rx_buffer  =  { { 0 }, 0, 0 };
   #endif
 
+  #if ENABLED(REALTIME_COMMANDS)
+    volatile uint8_t realtime_requests = 0;
+    bool realtime_bypass = false;
+    bool realtime_line_start = true;
+
+    // Ctrl-X, from the RX interrupt: the beam goes off and stays off, the stepper
+    // ISR drops the blocks without firing them. idle() does the rest.
+    void realtime_laser_kill() {
+      quickStopFromISR();
+      #if ENABLED(LASER)
+        laser_extinguish();
+      #endif
+      #if ENABLED(LASERBEAM)
+        laser_pwr = false;
+        laser_ttl_modulation = 0;
+        WRITE(LASER_PWR_PIN, LOW);
+        analogWrite(LASER_TTL_PIN, 0);
+      #endif
+      realtime_requests |= RT_REQ_LASER_KILL;
+    }
+  #endif
+
   FORCE_INLINE void store_char(unsigned char c) {
+    #if ENABLED(REALTIME_COMMANDS)
+      // Checked before the buffer is full, so they get through when the queue is stuck
+      if (realtime_char(c)) return;
+    #endif
     int i = (unsigned int)(rx_buffer.head + 1) % RX_BUFFER_SIZE;
     if (i != rx_buffer.tail) {
       rx_buffer.buffer[rx_buffer.head] = c;
@@ -60,7 +60,11 @@
   #define BIN 2
   #define BYTE 0
 
-  #define RX_BUFFER_SIZE 128
+  #if ENABLED(SD_BULK_UPLOAD)
+    #define RX_BUFFER_SIZE SD_BULK_RX_BUFFER // room for the frames in flight
+  #else
+    #define RX_BUFFER_SIZE 128
+  #endif
 
   struct ring_buffer {
     unsigned char buffer[RX_BUFFER_SIZE];
@@ -72,6 +76,40 @@
     extern ring_buffer rx_buffer;
   #endif
 
+  #if ENABLED(REALTIME_COMMANDS)
+    // Requests taken out of the RX stream, served by realtime_commands() in idle()
+    #define RT_REQ_STATUS     1
+    #define RT_REQ_FEED_HOLD  2
+    #define RT_REQ_RESUME     4
+    #define RT_REQ_LASER_KILL 8
+
+    extern volatile uint8_t realtime_requests;
+    extern bool realtime_bypass;     // binary transfers get every byte
+    extern bool realtime_line_start; // the last byte stored ended a line
+
+    void realtime_laser_kill();
+
+    // Take a real-time command byte out of the stream, true if c was one.
+    // The printable ones only count between lines, they can be part of a
+    // command (M23 LONGFI~1.GCO) and stripping them would break its checksum.
+    FORCE_INLINE bool realtime_char(unsigned char c) {
+      if (realtime_bypass) return false;
+      if (c == RT_LASER_KILL_CHAR) {
+        realtime_laser_kill();
+        return true;
+      }
+      if (realtime_line_start) switch (c) {
+        case RT_STATUS_CHAR:      realtime_requests |= RT_REQ_STATUS; return true;
+        #if ENABLED(FEED_HOLD)
+          case RT_FEED_HOLD_CHAR: realtime_requests |= RT_REQ_FEED_HOLD; return true;
+          case RT_RESUME_CHAR:    realtime_requests |= RT_REQ_RESUME; return true;
+        #endif
+      }
+      realtime_line_start = (c == '\n' || c == '\r');
+      return false;
+    }
+  #endif
+
   class MKHardwareSerial {
     public:
       MKHardwareSerial();
@@ -93,6 +131,9 @@
       FORCE_INLINE void checkRx(void) {
         if (TEST(M_UCSRxA, M_RXCx)) {
           unsigned char c  =  M_UDRx;
+          #if ENABLED(REALTIME_COMMANDS)
+            if (realtime_char(c)) return;
+          #endif
           int i = (unsigned int)(rx_buffer.head + 1) % RX_BUFFER_SIZE;
           if (i != rx_buffer.tail) {
             rx_buffer.buffer[rx_buffer.head] = c;
@@ -91,6 +91,9 @@ static bool relative_mode = false;  //Determines Absolute or Relative Coordinate
 static char serial_char;
 static int serial_count = 0;
 static boolean comment_mode = false;
+
+#include "communication/serial_frame.h"
+
 static char* seen_pointer; // < A pointer to find chars in the command string (X, Y, Z, E, etc.)
 const char* queued_commands_P = NULL; /* pointer to the current line in the active sequence of commands, or NULL when none */
 const int sensitive_pins[] = SENSITIVE_PINS; ///< Sensitive pin list for M42
@@ -260,8 +263,16 @@ double printer_usage_filament;
   #endif
 #endif
 
+#if ENABLED(EARLY_OK)
+  static bool early_ok[BUFSIZE]; // "ok" already sent when the command was queued
+  static void send_ok();
+#endif
+
 #if ENABLED(SDSUPPORT)
   static bool fromsd[BUFSIZE];
+  #if HAS(SD_POSITION)
+    static uint32_t command_sdpos[BUFSIZE]; // file position after the command
+  #endif
   #if ENABLED(SD_SETTINGS)
     millis_t config_last_update = 0;
     bool config_readed = false;
@@ -287,6 +298,28 @@ double printer_usage_filament;
 
 #if ENABLED(LASERBEAM)
   int laser_ttl_modulation = 0;
+  bool laser_pwr = false;
+#endif
+
+#if ENABLED(LASER) && ENABLED(LASER_MULTIPASS)
+  // One recorded move, positions in micrometres
+  typedef struct {
+    long target[Z_AXIS + 1];
+    uint16_t feedrate;
+    int intensity;
+    float ppm;
+    unsigned long duration;
+    uint8_t mode;
+    bool status;
+    #if ENABLED(LASER_POWER_RAMP)
+      int intensity_end;
+    #endif
+  } multipass_move_t;
+
+  static multipass_move_t multipass_moves[LASER_MULTIPASS_MOVES];
+  static multipass_move_t multipass_start; // where the recorded pass begins
+  static uint8_t multipass_count = 0, multipass_limit = 0;
+  static bool multipass_recording = false;
 #endif
 
 #if ENABLED(NPR2)
@@ -419,6 +452,9 @@ bool enqueuecommand(const char* cmd) {
   // This is dangerous if a mixing of serial and this happens
   char* command = command_queue[cmd_queue_index_w];
   strcpy(command, cmd);
+  #if ENABLED(EARLY_OK)
+    early_ok[cmd_queue_index_w] = false;
+  #endif
   ECHO_SMT(DB, SERIAL_ENQUEUEING, command);
   ECHO_EM("\"");
   cmd_queue_index_w = (cmd_queue_index_w + 1) % BUFSIZE;
@@ -732,11 +768,18 @@ void loop() {
         else {
           // Write the string from the read buffer to SD
           card.write_command(command);
-          ECHO_L(OK);
+          ok_to_send();
         }
       }
-      else
-        process_next_command();
+      else {
+        #if HAS(SD_POSITION)
+          uint8_t head = block_buffer_head;
+          process_next_command();
+          if (fromsd[cmd_queue_index_r]) plan_set_sdpos(head, command_sdpos[cmd_queue_index_r]);
+        #else
+          process_next_command();
+        #endif
+      }
 
     #else
 
@@ -765,7 +808,7 @@ void gcode_line_error(const char* err, bool doFlush = true) {
  *  - The active serial input (usually USB)
  *  - The SD card file being actively printed
  */
-void get_command() {
+static void get_available_commands() {
 
   if (drain_queued_commands_P()) return; // priority is given to non-serial commands
 
@@ -798,6 +841,10 @@ void get_command() {
       // end of line == end of comment
       comment_mode = false;
 
+      serial_frame_end_param();
+      const uint8_t frame = serial_frame, checksum = serial_checksum;
+      serial_frame = serial_checksum = 0;
+
       if (!serial_count) return; // empty lines just exit
 
       char* command = command_queue[cmd_queue_index_w];
@@ -809,35 +856,28 @@ void get_command() {
       #endif
 
       while (*command == ' ') command++; // skip any leading spaces
-      char* npos = (*command == 'N') ? command : NULL; // Require the N parameter to start the line
-      char* apos = strchr(command, '*');
-
-      if (npos) {
-        boolean M110 = strstr_P(command, PSTR("M110")) != NULL;
-        if (M110) {
-          char* n2pos = strchr(command + 4, 'N');
-          if (n2pos) npos = n2pos;
-        }
-        gcode_N = strtol(npos + 1, NULL, 10);
+
+      if (frame & FRAME_N) { // Require the N parameter to start the line
+        boolean M110 = frame & FRAME_M110,
+                M110_N = frame & FRAME_M110_N;
+        gcode_N = M110_N ? serial_m110_n : serial_line_n;
         if (gcode_N != gcode_LastN + 1 && !M110) {
           gcode_line_error(PSTR(SERIAL_ERR_LINE_NO));
           return;
         }
-        if (apos) {
-          byte checksum = 0, count = 0;
-          while (command[count] != '*') checksum ^= command[count++];
-          if (strtol(apos + 1, NULL, 10) != checksum) {
+        if (frame & FRAME_STAR) {
+          if (serial_star_value != checksum) {
             gcode_line_error(PSTR(SERIAL_ERR_CHECKSUM_MISMATCH));
             return;
           }
           // if no errors, continue parsing
-        } else if (npos == command) {
+        } else if (!M110_N) {
           gcode_line_error(PSTR(SERIAL_ERR_NO_CHECKSUM));
           return;
         }
         gcode_LastN = gcode_N;
         // if no errors, continue parsing
-      } else if (apos) { // No '*' without 'N'
+      } else if (frame & FRAME_STAR) { // No '*' without 'N'
         gcode_line_error(PSTR(SERIAL_ERR_NO_LINENUMBER_WITH_CHECKSUM), false);
         return;
       }
@@ -862,22 +902,40 @@ void get_command() {
       // If command was e-stop process now
       if (strcmp(command, "M112") == 0) kill(PSTR(MSG_KILLED));
 
+      #if ENABLED(EARLY_OK)
+        // Lines for the file being written are acknowledged once they are on the SD
+        #if ENABLED(SDSUPPORT)
+          const bool ok_now = !card.saving;
+        #else
+          const bool ok_now = true;
+        #endif
+        early_ok[cmd_queue_index_w] = ok_now;
+      #endif
+
       cmd_queue_index_w = (cmd_queue_index_w + 1) % BUFSIZE;
       commands_in_queue += 1;
 
+      #if ENABLED(EARLY_OK)
+        if (ok_now) send_ok(); // the host can send the next line while this one waits in the queue
+      #endif
+
       serial_count = 0; //clear buffer
     }
     else if (serial_char == '\\') { // Handle escapes
       if (MKSERIAL.available() > 0 && commands_in_queue < BUFSIZE) {
         // if we have one more character, copy it over
         serial_char = MKSERIAL.read();
+        serial_frame_add(serial_char);
         command_queue[cmd_queue_index_w][serial_count++] = serial_char;
       }
       // otherwise do nothing
     }
     else { // its not a newline, carriage return or escape char
       if (serial_char == ';') comment_mode = true;
-      if (!comment_mode) command_queue[cmd_queue_index_w][serial_count++] = serial_char;
+      if (!comment_mode) {
+        serial_frame_add(serial_char);
+        command_queue[cmd_queue_index_w][serial_count++] = serial_char;
+      }
     }
   }
 
@@ -920,6 +978,12 @@ void get_command() {
         command_queue[cmd_queue_index_w][serial_count] = 0; //terminate string
         // if (!comment_mode) {
         fromsd[cmd_queue_index_w] = true;
+        #if HAS(SD_POSITION)
+          command_sdpos[cmd_queue_index_w] = card.sdpos;
+        #endif
+        #if ENABLED(EARLY_OK)
+          early_ok[cmd_queue_index_w] = false;
+        #endif
         commands_in_queue += 1;
         cmd_queue_index_w = (cmd_queue_index_w + 1) % BUFSIZE;
         // }
@@ -934,6 +998,20 @@ void get_command() {
   #endif // SDSUPPORT
 }
 
+/**
+ * Fill the command queue. get_command() is also called from idle(),
+ * so a call nested in a running one (e.g. SD end of file waiting
+ * for the moves in printingHasFinished()) returns at once instead of
+ * appending to the line that is still being assembled.
+ */
+void get_command() {
+  static bool reading = false;
+  if (reading) return;
+  reading = true;
+  get_available_commands();
+  reading = false;
+}
+
 bool code_has_value() {
   int i = 1;
   char c = seen_pointer[i];
@@ -2905,6 +2983,9 @@ inline void gcode_G0_G1(bool lfire) {
          if (code_seen('P') && IsRunning()) laser.ppm = (float) code_value();
          if (code_seen('D') && IsRunning()) laser.diagnostics = (bool) code_value();
          if (code_seen('B') && IsRunning()) laser_set_mode((int) code_value());
+         #if ENABLED(LASER_POWER_RAMP)
+           if (code_seen('Q') && IsRunning()) laser.intensity_end = constrain(code_value_short(), 0, 10000);
+         #endif
 
          laser.status = LASER_ON;
          laser.fired = LASER_FIRE_G1;
@@ -2916,6 +2997,13 @@ inline void gcode_G0_G1(bool lfire) {
     #if ENABLED(LASER) && ENABLED(LASER_FIRE_G1)
       if(lfire) {
          laser.status = LASER_OFF;
+         #if ENABLED(LASER_POWER_RAMP)
+           // The following moves continue at the end intensity
+           if (laser.intensity_end >= 0) {
+             laser.intensity = laser.intensity_end;
+             laser.intensity_end = -1;
+           }
+         #endif
       }
     #endif
 
@@ -2978,6 +3066,22 @@ inline void gcode_G4() {
   if (code_seen('P')) codenum = code_value_long(); // milliseconds to wait
   if (code_seen('S')) codenum = code_value() * 1000; // seconds to wait
 
+  #if ENABLED(LASER) && ENABLED(LASER_MULTIPASS)
+    if (multipass_recording && codenum) {
+      multipass_recording = false;
+      ECHO_LM(ER, "Multipass: dwells can't be recorded");
+    }
+  #endif
+
+  #if ENABLED(PLANNER_DWELL)
+    // The stepper runs the dwell in sequence, the next commands are planned meanwhile
+    if (codenum) {
+      plan_buffer_dwell(codenum);
+      refresh_cmd_timeout();
+      return;
+    }
+  #endif
+
   st_synchronize();
   refresh_cmd_timeout();
   codenum += previous_cmd_ms;  // keep track of when we started waiting
@@ -3123,7 +3227,7 @@ prepare_move(); // Create a block just to move in Y.
 }
 if (code_seen('L')) 
 laser.raster_raw_length = int(code_value());
-  if (code_seen('D')) laser.raster_num_pixels = base64_decode(laser.raster_data, seen_pointer+1, laser.raster_raw_length);
+  if (code_seen('D')) laser.raster_num_pixels = laser_raster_decode(plan_raster_slot(), seen_pointer+1, laser.raster_raw_length);
   if (!laser.raster_direction) {
     destination[X_AXIS] = current_position[X_AXIS] - (laser.raster_mm_per_pulse * laser.raster_num_pixels);
     if (laser.diagnostics) {
@@ -4431,9 +4535,34 @@ inline void gcode_G92() {
   }
 #endif //ULTIPANEL
 
+#if ENABLED(LASERBEAM)
+  /**
+   * Laser beam power and modulation are stored in every planned block and
+   * set by the stepper ISR when the block starts, and when the planner runs
+   * dry. On and off both go with the next planned move, with nothing planned
+   * the pins are set now.
+   */
+  void laser_beam_sync() {
+    if (blocks_queued()) return;
+    WRITE(LASER_PWR_PIN, laser_pwr);
+    analogWrite(LASER_TTL_PIN, laser_ttl_modulation);
+  }
+
+  // Switch the beam off now, the planned blocks lose their beam too (M81)
+  void laser_beam_kill() {
+    laser_pwr = false;
+    laser_ttl_modulation = 0;
+    plan_laser_beam_off();
+    WRITE(LASER_PWR_PIN, LOW);
+    analogWrite(LASER_TTL_PIN, 0);
+  }
+#endif
+
 #if (ENABLED(LASERBEAM) || ENABLED(LASER) && ENABLED(LASER_FIRE_SPINDLE))
   /**
-   * M3: S - Setting laser beam or fire laser 
+   * M3: S - Setting laser beam or fire laser
+   *
+   * The new state goes with the next planned move, queued moves finish unchanged.
    */
   inline void gcode_M3() {
     #if ENABLED(LASERBEAM)
@@ -4443,6 +4572,7 @@ inline void gcode_G92() {
     else {
       laser_ttl_modulation = 0;
     }
+    laser_beam_sync();
     #endif
     #if ENABLED(LASER) && ENABLED(LASER_FIRE_SPINDLE)
     if (code_seen('S') && IsRunning()) laser.intensity = (int) code_value();
@@ -4453,11 +4583,6 @@ inline void gcode_G92() {
 
     laser.status = LASER_ON;
     laser.fired = LASER_FIRE_SPINDLE;
-
-    lcd_update();
-
-    prepare_move();
-
     #endif
   }
 
@@ -4466,8 +4591,9 @@ inline void gcode_G92() {
    */
   inline void gcode_M4() {
     #if ENABLED(LASERBEAM)
-    WRITE(LASER_PWR_PIN, HIGH);
+    laser_pwr = true;
     laser_ttl_modulation = 0;
+    laser_beam_sync();
     #endif
     #if ENABLED(LASER) && ENABLED(LASER_FIRE_SPINDLE)
       gcode_M3();
@@ -4480,13 +4606,14 @@ inline void gcode_G92() {
    */
   inline void gcode_M5() {
     #if ENABLED(LASERBEAM)
-    WRITE(LASER_PWR_PIN, LOW);
+    laser_pwr = false;
     laser_ttl_modulation = 0;
+    laser_beam_sync();
     #endif
     #if ENABLED(LASER) && ENABLED(LASER_FIRE_SPINDLE)
       laser.status = LASER_OFF;
-      lcd_update();
-      prepare_move();
+      // The stepper ISR turns the laser off at the next block, with nothing planned do it now
+      if (!blocks_queued()) laser_extinguish();
     #endif
   }
 #endif //LASERBEAM
@@ -4568,6 +4695,12 @@ inline void gcode_M17() {
    * M24: Start SD Print
    */
   inline void gcode_M24() {
+    #if ENABLED(LASER_RASTER_RESUME)
+      if (card.sdpos == 0) raster_resume_start();
+    #endif
+    #if ENABLED(POWER_LOSS_JOURNAL)
+      if (card.sdpos == 0) card.journalStart();
+    #endif
     card.startPrint();
     print_job_start_ms = millis();
     #if HAS(POWER_CONSUMPTION_SENSOR)
@@ -4599,8 +4732,24 @@ inline void gcode_M17() {
 
   /**
    * M28: Start SD Write
+   *
+   *  M28 B1 filename - Receive the file in binary blocks (see CardReader::bulkWrite)
    */
   inline void gcode_M28() {
+    #if ENABLED(SD_BULK_UPLOAD)
+      char* args = current_command_args;
+      if (args[0] == 'B' && args[1] == '1' && args[2] == ' ') {
+        card.startWrite(args + 3, false);
+        #if ENABLED(REALTIME_COMMANDS)
+          realtime_bypass = true; // the frames are binary
+        #endif
+        if (card.saving) card.bulkWrite();
+        #if ENABLED(REALTIME_COMMANDS)
+          realtime_bypass = false;
+        #endif
+        return;
+      }
+    #endif
     card.startWrite(current_command_args, false);
   }
 
@@ -4966,7 +5115,7 @@ inline void gcode_M81() {
   finishAndDisableSteppers();
   fanSpeed = 0;
   #if ENABLED(LASERBEAM)
-    laser_ttl_modulation = 0;
+    laser_beam_kill();
   #endif
   delay_ms(1000); // Wait 1 second before switching off
   #if HAS(SUICIDE)
@@ -5296,7 +5445,10 @@ inline void gcode_M105() {
   if (setTargetedExtruder(105)) return;
 
   #if HAS(TEMP_0) || HAS(TEMP_BED) || ENABLED(HEATER_0_USES_MAX6675)
-    ECHO_S(OK);
+    #if ENABLED(EARLY_OK)
+      if (!early_ok[cmd_queue_index_r])
+    #endif
+        ECHO_S(OK);
     print_heaterstates();
   #else // HASNT(TEMP_0) && HASNT(TEMP_BED)
     ECHO_LM(ER, SERIAL_ERR_NO_THERMISTORS);
@@ -5432,6 +5584,109 @@ inline void gcode_M114() {
   #endif
 }
 
+#if ENABLED(AUTO_REPORT_STATUS) || ENABLED(REALTIME_COMMANDS)
+
+  /**
+   * One line with temperatures, position, laser and queue state
+   */
+  static void report_status_line() {
+    #if HAS(TEMP_0) || HAS(TEMP_BED) || ENABLED(HEATER_0_USES_MAX6675)
+      print_heaterstates();
+      ECHO_M(" ");
+    #endif
+
+    ECHO_MV("X:", st_get_axis_position_mm(X_AXIS));
+    ECHO_MV(" Y:", st_get_axis_position_mm(Y_AXIS));
+    ECHO_MV(" Z:", st_get_axis_position_mm(Z_AXIS));
+    #if ENABLED(LASER)
+      ECHO_MV(" L:", (int)laser.firing);
+      ECHO_MV(" S:", laser.intensity);
+      ECHO_MV(" M:", (int)laser.mode);
+    #endif
+    ECHO_MV(" Q:", commands_in_queue);
+    #if ENABLED(FEED_HOLD)
+      ECHO_MV(" H:", (int)st_feed_held());
+    #endif
+    ECHO_EMV(" P:", (int)movesplanned());
+  }
+
+#endif
+
+#if ENABLED(AUTO_REPORT_STATUS)
+
+  static uint8_t auto_report_interval = 0; // seconds, 0 = off
+  static millis_t next_auto_report_ms;
+
+  /**
+   * M155: Set the status auto-report interval
+   *
+   *   S<seconds> Interval between two status lines, 0 to stop
+   */
+  inline void gcode_M155() {
+    if (code_seen('S')) {
+      auto_report_interval = constrain(code_value_short(), 0, 60);
+      next_auto_report_ms = millis() + auto_report_interval * 1000UL;
+    }
+  }
+
+  /**
+   * Send the status line when it's due. Called from idle(),
+   * it doesn't use the command queue.
+   */
+  static void auto_report_status() {
+    if (!auto_report_interval || (long)(millis() - next_auto_report_ms) < 0) return;
+    next_auto_report_ms = millis() + auto_report_interval * 1000UL;
+    report_status_line();
+  }
+
+#endif // AUTO_REPORT_STATUS
+
+#if ENABLED(REALTIME_COMMANDS)
+
+  /**
+   * Serve the real-time bytes taken out of the serial stream by the
+   * RX interrupt. Called from idle(), so it runs even when the command
+   * queue waits on a full planner buffer.
+   */
+  static void realtime_commands() {
+    if (!realtime_requests) return;
+    CRITICAL_SECTION_START;
+    uint8_t requests = realtime_requests;
+    realtime_requests = 0;
+    CRITICAL_SECTION_END;
+
+    if (requests & RT_REQ_LASER_KILL) {
+      // Drop the planned moves, so no block fires the beam again, and stop like M112 without the reset
+      quickStop();
+      #if ENABLED(SDSUPPORT)
+        if (card.sdprinting) {
+          card.sdprinting = false;
+          card.closeFile();
+        }
+      #endif
+      Stop();
+      return;
+    }
+    #if ENABLED(FEED_HOLD)
+      if (requests & RT_REQ_FEED_HOLD) {
+        #if ENABLED(SDSUPPORT)
+          card.pausePrint();
+        #endif
+        st_feed_hold();
+      }
+      if (requests & RT_REQ_RESUME) {
+        #if ENABLED(SDSUPPORT)
+          // Pick up a paused SD job too, M24 may be stuck behind the held moves
+          if (st_feed_held() && card.isFileOpen() && !card.sdprinting && !card.saving) card.startPrint();
+        #endif
+        st_feed_resume();
+      }
+    #endif
+    if (requests & RT_REQ_STATUS) report_status_line();
+  }
+
+#endif // REALTIME_COMMANDS
+
 /**
  * M115: Capabilities string
  */
@@ -6095,6 +6350,7 @@ inline void gcode_M226() {
     uint16_t beepS = code_seen('S') ? code_value_short() : 100;
     uint32_t beepP = code_seen('P') ? code_value_long() : 1000;
     if (beepP > 5000) beepP = 5000; // limit to 5 seconds
+    while (buzzer_queue_full()) idle(); // keep the notes of a song
     buzz(beepP, beepS);
   }
 
@@ -6694,6 +6950,86 @@ inline void gcode_M400() { st_synchronize(); }
  */
 inline void gcode_M410() { quickStop(); }
 
+#if ENABLED(POWER_LOSS_JOURNAL)
+  /**
+   * M413: Power loss journal
+   *
+   *   R Continue the journaled SD job after its last completed move.
+   *     X and Y must be homed, Z is restored only if homed too.
+   *     The file must be the same name and size.
+   *   C Discard the journal
+   *
+   * Without parameters the last checkpoint is printed.
+   */
+  inline void gcode_M413() {
+    if (code_seen('C')) {
+      card.journalClear();
+      return;
+    }
+
+    journal_t record;
+    if (IS_SD_PRINTING || !card.journalLoad(record)) {
+      ECHO_LM(DB, "No journal to resume");
+      return;
+    }
+
+    ECHO_SMT(DB, "Journal ", record.filename);
+    ECHO_MV(" byte ", (unsigned long)record.sdpos);
+    ECHO_MV(" X", record.position[X_AXIS]);
+    ECHO_MV(" Y", record.position[Y_AXIS]);
+    ECHO_MV(" Z", record.position[Z_AXIS]);
+    ECHO_MV(" F", record.feedrate);
+    #if ENABLED(LASER)
+      ECHO_MV(" S", record.laser_intensity);
+      ECHO_MV(" mode ", (int)record.laser_mode);
+      ECHO_EMV(" spindle ", (int)record.laser_spindle);
+    #else
+      ECHO_E;
+    #endif
+
+    if (!code_seen('R')) return;
+
+    if (!TEST(axis_known_position, X_AXIS) || !TEST(axis_known_position, Y_AXIS)) {
+      ECHO_LM(ER, "Home X and Y before resuming");
+      return;
+    }
+    if (!card.selectFile(record.filename) || card.fileSize != record.filesize) {
+      ECHO_LM(ER, "Journal file not found or changed");
+      return;
+    }
+
+    // Go to the end of the last completed move with the laser off
+    #if ENABLED(LASER)
+      laser.mode = CONTINUOUS;
+      laser.status = LASER_OFF;
+    #endif
+    set_destination_to_current();
+    destination[X_AXIS] = record.position[X_AXIS];
+    destination[Y_AXIS] = record.position[Y_AXIS];
+    if (TEST(axis_known_position, Z_AXIS)) destination[Z_AXIS] = record.position[Z_AXIS];
+    prepare_move();
+    st_synchronize();
+
+    feedrate = record.feedrate;
+    #if ENABLED(LASER)
+      laser.intensity = record.laser_intensity;
+      if (record.laser_mode != RASTER) laser.mode = record.laser_mode; // G7 sets its own mode
+      laser.status = LASER_OFF;
+      #if ENABLED(LASER_FIRE_SPINDLE)
+        if (record.laser_spindle) {
+          laser.status = LASER_ON;
+          laser.fired = LASER_FIRE_SPINDLE;
+        }
+      #endif
+    #endif
+
+    card.setIndex(record.sdpos);
+    card.journalStart(true);
+    card.startPrint();
+    print_job_start_ms = millis();
+  }
+#endif // POWER_LOSS_JOURNAL
+
 /**
  * M428: Set home_offset based on the distance between the
  *       current_position and the nearest "reference point."
@@ -7053,11 +7389,244 @@ inline void gcode_M503() {
     if (code_seen('D') && IsRunning()) laser.diagnostics = (bool) code_value();
     if (code_seen('B') && IsRunning()) laser_set_mode((int) code_value());
     if (code_seen('R') && IsRunning()) laser.raster_mm_per_pulse = ((float) code_value());
+    #if ENABLED(REALTIME_OVERRIDES)
+      if (code_seen('O')) laser.power_scale = ((long)constrain(code_value_short(), 0, 200) << 8) / 100;
+    #endif
     if (code_seen('F')) {
       float next_feedrate = code_value();
       if(next_feedrate > 0.0) feedrate = next_feedrate;
     }
   }
+
+  #if ENABLED(LASER_MULTIPASS)
+
+    static void multipass_store(multipass_move_t &move, const float pos[]) {
+      for (uint8_t i = X_AXIS; i <= Z_AXIS; i++) move.target[i] = lround(pos[i] * 1000.0);
+      move.feedrate = feedrate;
+      move.intensity = laser.intensity;
+      move.ppm = laser.ppm;
+      move.duration = laser.duration;
+      move.mode = laser.mode;
+      move.status = laser.status;
+      #if ENABLED(LASER_POWER_RAMP)
+        move.intensity_end = laser.intensity_end;
+      #endif
+    }
+
+    // Called by prepare_move and plan_arc for every planned line while recording
+    void multipass_record(const float target[]) {
+      #if ENABLED(LASER_RASTER)
+        if (laser.mode == RASTER) {
+          multipass_recording = false;
+          ECHO_LM(ER, "Multipass: raster lines can't be recorded");
+          return;
+        }
+      #endif
+      multipass_store(multipass_moves[multipass_count++], target);
+      if (multipass_count >= multipass_limit) {
+        multipass_recording = false;
+        ECHO_LMV(DB, "Multipass: recorded moves ", (int)multipass_count);
+      }
+    }
+
+    /**
+     * M660: Record the next moves for multipass
+     *
+     *   N<moves> Number of moves to record (default and max LASER_MULTIPASS_MOVES)
+     */
+    inline void gcode_M660() {
+      multipass_limit = LASER_MULTIPASS_MOVES;
+      if (code_seen('N')) multipass_limit = constrain(code_value_short(), 1, LASER_MULTIPASS_MOVES);
+      multipass_count = 0;
+      multipass_store(multipass_start, current_position);
+      multipass_start.status = LASER_OFF;
+      multipass_recording = true;
+    }
+
+    /**
+     * M661: Stop recording and replay the recorded moves
+     *
+     *   S<passes> Number of times the recorded moves are replayed (default 1)
+     *   Z<mm>     Z change before every replayed pass
+     */
+    inline void gcode_M661() {
+      multipass_recording = false;
+      if (!multipass_count) return;
+
+      int passes = code_seen('S') ? code_value_short() : 1;
+      float z_step = code_seen('Z') ? code_value() : 0.0,
+            z_offset = 0.0;
+
+      // Laser state of the running job is restored after the replay
+      multipass_move_t saved;
+      multipass_store(saved, current_position);
+
+      for (int pass = 0; pass < passes && IsRunning(); pass++) {
+        z_offset += z_step;
+        for (int i = -1; i < multipass_count && IsRunning(); i++) {
+          const multipass_move_t &move = i < 0 ? multipass_start : multipass_moves[i];
+          for (uint8_t j = X_AXIS; j <= Z_AXIS; j++) destination[j] = move.target[j] / 1000.0;
+          destination[Z_AXIS] += z_offset;
+          destination[E_AXIS] = current_position[E_AXIS];
+          feedrate = move.feedrate;
+          laser.intensity = move.intensity;
+          laser.ppm = move.ppm;
+          laser.duration = move.duration;
+          laser.mode = move.mode;
+          laser.status = move.status;
+          #if ENABLED(LASER_POWER_RAMP)
+            laser.intensity_end = move.intensity_end;
+          #endif
+          prepare_move();
+        }
+      }
+
+      feedrate = saved.feedrate;
+      laser.intensity = saved.intensity;
+      laser.ppm = saved.ppm;
+      laser.duration = saved.duration;
+      laser.mode = saved.mode;
+      laser.status = saved.status;
+      #if ENABLED(LASER_POWER_RAMP)
+        laser.intensity_end = saved.intensity_end;
+      #endif
+    }
+
+  #endif // LASER_MULTIPASS
+
+  #if ENABLED(LASER_CURRENT_HISTOGRAM)
+    /**
+     * M652: Print the laser current histogram
+     *
+     *   R Clear the histogram
+     */
+    inline void gcode_M652() {
+      if (code_seen('R')) laser_current_reset();
+      else laser_current_report();
+    }
+  #endif
+
+  #if ENABLED(LASER_POWER_CALIBRATION)
+
+    static float laser_cal_response[LASER_CAL_POINTS];
+
+    static void laser_cal_print() {
+      for (uint8_t i = 0; i < LASER_CAL_POINTS; i++) {
+        ECHO_SMV(DB, "M653 P", (int)i);
+        ECHO_EMV(" C", laser_cal_curve[i]);
+      }
+    }
+
+    /**
+     * M653: Laser power calibration
+     *
+     *   S<ms>          Sweep the output intensity, firing S milliseconds at every point,
+     *                  measure the tube current and fit the curve (needs POWER_CONSUMPTION)
+     *   P<point> V<n>  Enter the response measured (e.g. burn depth) at output point P
+     *   F              Fit the curve from the entered responses
+     *   P<point> C<n>  Set a curve point directly
+     *   R              Reset to the uncorrected curve
+     *
+     * Without parameters the curve is printed. Use M500 to save it.
+     */
+    inline void gcode_M653() {
+      if (code_seen('R')) {
+        laser_cal_reset();
+        return;
+      }
+
+      if (code_seen('P')) {
+        int point = code_value_short();
+        if (point < 0 || point >= LASER_CAL_POINTS) {
+          ECHO_LM(ER, "Calibration point out of range");
+          return;
+        }
+        if (code_seen('V')) laser_cal_response[point] = code_value();
+        if (code_seen('C')) laser_cal_curve[point] = constrain(code_value_short(), 0, 10000);
+        return;
+      }
+
+      #if HAS(POWER_CONSUMPTION_SENSOR)
+        if (code_seen('S')) {
+          millis_t shot = code_value_long();
+          st_synchronize();
+          for (uint8_t i = 0; i < LASER_CAL_POINTS && IsRunning(); i++) {
+            int output = (long)i * 10000 / (LASER_CAL_POINTS - 1);
+            if (output) laser_fire(output);
+            millis_t end = millis() + shot;
+            while (millis() < end && IsRunning()) idle();
+            laser_cal_response[i] = analog2current();
+            laser_extinguish();
+            ECHO_SMV(DB, "Output ", output);
+            ECHO_EMV(" I:", laser_cal_response[i], 3);
+            end = millis() + shot;
+            while (millis() < end && IsRunning()) idle(); // let the tube recover
+          }
+          if (!IsRunning()) return;
+          if (!laser_cal_fit(laser_cal_response)) ECHO_LM(ER, "No laser response measured");
+        }
+      #endif
+
+      if (code_seen('F') && !laser_cal_fit(laser_cal_response)) ECHO_LM(ER, "No laser response entered");
+
+      laser_cal_print();
+    }
+
+  #endif // LASER_POWER_CALIBRATION
+
+  #if ENABLED(LASER_RASTER_RESUME)
+    /**
+     * M654: Raster job resume
+     *
+     *   R Continue the saved raster job after its last completed line.
+     *     X and Y must be homed, the file must be the same name and size.
+     *
+     * Without parameters the saved progress is printed, during an SD job the live one.
+     */
+    inline void gcode_M654() {
+      if (!IS_SD_PRINTING && !raster_resume_load()) {
+        ECHO_LM(DB, "No raster job to resume");
+        return;
+      }
+
+      ECHO_SMT(DB, "Raster job ", raster_resume.filename);
+      ECHO_MV(" line ", (int)raster_resume.line);
+      ECHO_MV(" byte ", (unsigned long)raster_resume.sdpos);
+      ECHO_MV(" X", raster_resume.position[X_AXIS]);
+      ECHO_EMV(" Y", raster_resume.position[Y_AXIS]);
+
+      if (!code_seen('R') || IS_SD_PRINTING) return;
+
+      if (!TEST(axis_known_position, X_AXIS) || !TEST(axis_known_position, Y_AXIS)) {
+        ECHO_LM(ER, "Home X and Y before resuming");
+        return;
+      }
+      if (!card.selectFile(raster_resume.filename) || card.fileSize != raster_resume.filesize) {
+        ECHO_LM(ER, "Raster job file not found or changed");
+        return;
+      }
+
+      feedrate = raster_resume.feedrate;
+      laser.raster_mm_per_pulse = raster_resume.raster_mm_per_pulse;
+      laser.rasterlaserpower = raster_resume.rasterlaserpower;
+      laser.raster_raw_length = raster_resume.raster_raw_length;
+      laser.raster_direction = raster_resume.raster_direction;
+
+      // Go to the end of the last completed line with the laser off
+      laser.mode = CONTINUOUS;
+      laser.status = LASER_OFF;
+      set_destination_to_current();
+      destination[X_AXIS] = raster_resume.position[X_AXIS];
+      destination[Y_AXIS] = raster_resume.position[Y_AXIS];
+      prepare_move();
+      st_synchronize();
+
+      card.setIndex(raster_resume.sdpos);
+      card.startPrint(); // the line count goes on from the resumed line
+      print_job_start_ms = millis();
+    }
+  #endif // LASER_RASTER_RESUME
+
   #if ENABLED(MUVE_Z_PEEL)
   // M650 set peel distance
   inline void gcode_M650() {
@@ -7868,6 +8437,11 @@ void process_next_command() {
           gcode_M150(); break;
       #endif //BLINKM
 
+      #if ENABLED(AUTO_REPORT_STATUS)
+        case 155: // M155 Set the status auto-report interval
+          gcode_M155(); break;
+      #endif
+
       #if ENABLED(COLOR_MIXING_EXTRUDER)
         case 163: // M163 S<int> P<float> set weight for a mixing extruder
           gcode_M163(); break;
@@ -8013,6 +8587,11 @@ void process_next_command() {
       case 410: // M410 quickstop - Abort all the planned moves.
         gcode_M410(); break;
 
+      #if ENABLED(POWER_LOSS_JOURNAL)
+        case 413: // M413 Power loss journal, resume the SD job
+          gcode_M413(); break;
+      #endif
+
       case 428: // M428 Apply current_position to home_offset
         gcode_M428(); break;
 
@@ -8054,6 +8633,28 @@ void process_next_command() {
         case 649: // M649 set laser options
           gcode_M649(); break;
 
+        #if ENABLED(LASER_MULTIPASS)
+          case 660: // M660 record moves for multipass
+            gcode_M660(); break;
+          case 661: // M661 replay recorded moves
+            gcode_M661(); break;
+        #endif
+
+        #if ENABLED(LASER_CURRENT_HISTOGRAM)
+          case 652: // M652 laser current histogram
+            gcode_M652(); break;
+        #endif
+
+        #if ENABLED(LASER_POWER_CALIBRATION)
+          case 653: // M653 laser power calibration
+            gcode_M653(); break;
+        #endif
+
+        #if ENABLED(LASER_RASTER_RESUME)
+          case 654: // M654 raster job resume
+            gcode_M654(); break;
+        #endif
+
         #if ENABLED(MUVE_Z_PEEL)
           case 650:
             gcode_M650(); break;
@@ -8115,11 +8716,7 @@ void FlushSerialRequestResend() {
   ECHO_S(OK);
 }
 
-void ok_to_send() {
-  refresh_cmd_timeout();
-  #if ENABLED(SDSUPPORT)
-    if (fromsd[cmd_queue_index_r]) return;
-  #endif
+static void send_ok() {
   ECHO_S(OK);
   #if ENABLED(ADVANCED_OK)
     ECHO_MV("N", gcode_LastN);
@@ -8129,6 +8726,17 @@ void ok_to_send() {
   ECHO_E;
 }
 
+void ok_to_send() {
+  refresh_cmd_timeout();
+  #if ENABLED(SDSUPPORT)
+    if (fromsd[cmd_queue_index_r]) return;
+  #endif
+  #if ENABLED(EARLY_OK)
+    if (early_ok[cmd_queue_index_r]) return;
+  #endif
+  send_ok();
+}
+
 void clamp_to_software_endstops(float target[3]) {
   if (SOFTWARE_MIN_ENDSTOPS && software_endstops) {
     NOLESS(target[X_AXIS], min_pos[X_AXIS]);
@@ -8178,6 +8786,11 @@ void clamp_to_software_endstops(float target[3]) {
     float fractions[NUM_AXIS];
     float frfm = feedrate / 60 * feedrate_multiplier / 100.0;
 
+    #if ENABLED(LASER) && ENABLED(LASER_POWER_RAMP)
+      // A ramp runs once over the whole move, every segment gets its part of it
+      const int ramp_start = laser.intensity, ramp_end = laser.intensity_end;
+    #endif
+
     for (uint8_t i = 0; i < NUM_AXIS; i++) difference[i] = target[i] - current_position[i];
 
     float cartesian_mm = sqrt(sq(difference[X_AXIS]) + sq(difference[Y_AXIS]) + sq(difference[Z_AXIS]));
@@ -8237,8 +8850,26 @@ void clamp_to_software_endstops(float target[3]) {
         ECHO_LMV(DEB, "delta[TOWER_3]=", delta[TOWER_3]);
       }
 
+      #if ENABLED(LASER) && ENABLED(LASER_POWER_RAMP)
+        if (ramp_end >= 0) {
+          laser.intensity = ramp_start + (long)(ramp_end - ramp_start) * (s - 1) / steps;
+          laser.intensity_end = ramp_start + (long)(ramp_end - ramp_start) * s / steps;
+        }
+      #endif
+
+      #if ENABLED(REALTIME_OVERRIDES)
+        plan_feed_multiplier = feedrate_multiplier;
+      #endif
       plan_buffer_line(delta[TOWER_1], delta[TOWER_2], delta[TOWER_3], target[E_AXIS], frfm, active_extruder, active_driver);
+      #if ENABLED(REALTIME_OVERRIDES)
+        plan_feed_multiplier = 0;
+      #endif
     }
+
+    #if ENABLED(LASER) && ENABLED(LASER_POWER_RAMP)
+      laser.intensity = ramp_start;
+      laser.intensity_end = ramp_end;
+    #endif
     return true;
   }
 
@@ -8306,7 +8937,13 @@ void clamp_to_software_endstops(float target[3]) {
       #endif
     }
     else {
+      #if ENABLED(REALTIME_OVERRIDES)
+        plan_feed_multiplier = feedrate_multiplier; // planned blocks follow later changes
+      #endif
       line_to_destination(feedrate * feedrate_multiplier / 100.0);
+      #if ENABLED(REALTIME_OVERRIDES)
+        plan_feed_multiplier = 0;
+      #endif
     }
     return true;
   }
@@ -8341,6 +8978,10 @@ void prepare_move() {
     if (!prepare_move_cartesian()) return;
   #endif
 
+  #if ENABLED(LASER) && ENABLED(LASER_MULTIPASS)
+    if (multipass_recording) multipass_record(destination);
+  #endif
+
   set_current_to_destination();
 }
 
@@ -8464,6 +9105,9 @@ void plan_arc(
     #else
       plan_buffer_line(arc_target[X_AXIS], arc_target[Y_AXIS], arc_target[Z_AXIS], arc_target[E_AXIS], feed_rate, active_extruder, active_driver);
     #endif
+    #if ENABLED(LASER) && ENABLED(LASER_MULTIPASS)
+      if (multipass_recording) multipass_record(arc_target);
+    #endif
   }
 
   // Ensure last segment arrives at target location.
@@ -8474,6 +9118,9 @@ void plan_arc(
   #else
     plan_buffer_line(target[X_AXIS], target[Y_AXIS], target[Z_AXIS], target[E_AXIS], feed_rate, active_extruder, active_driver);
   #endif
+  #if ENABLED(LASER) && ENABLED(LASER_MULTIPASS)
+    if (multipass_recording) multipass_record(target);
+  #endif
 
   // As far as the parser is concerned, the position is now == target. In reality the
   // motion control system might still be processing the action and the real tool position
@@ -8628,13 +9275,82 @@ void plan_arc(
 
 #endif
 
+#if ENABLED(IDLE_TASK_SCHEDULER)
+
+  static bool idle_ignore_stepper_queue = false;
+
+  static void idle_task_heater()     { manage_heater(); }
+  static void idle_task_inactivity() { manage_inactivity(idle_ignore_stepper_queue); }
+  static void idle_task_lcd()        { lcd_update(); }
+
+  typedef struct {
+    void (*run)();
+    uint16_t period_ms;   // Minimum time between two runs
+    uint16_t deadline_ms; // Maximum delay after which the task runs even if the planner is hungry
+    uint16_t budget_us;   // Expected worst case duration of one run
+    millis_t next_ms;     // Time of the next run
+  } idle_task_t;
+
+  // Sorted by priority, highest first
+  static idle_task_t idle_tasks[] = {
+    { idle_task_heater,       0,  100,  400, 0 },
+    { idle_task_inactivity,  10,  200,  300, 0 },
+    { idle_task_lcd,        100, 1000, 5000, 0 }
+  };
+
+  /**
+   * Run the periodic tasks that are due.
+   * When the planner is below the watermark the serial and command queue
+   * are refilled first, and only the tasks that fit in the remaining slice
+   * or that missed their deadline are run.
+   */
+  static void idle_scheduler() {
+    millis_t ms = millis();
+    bool hungry = movesplanned() < (IDLE_PLANNER_WATERMARK);
+
+    if (hungry && commands_in_queue < BUFSIZE - 1) get_command();
+
+    unsigned long start_us = micros();
+
+    for (uint8_t i = 0; i < COUNT(idle_tasks); i++) {
+      idle_task_t &task = idle_tasks[i];
+      long late_ms = (long)(ms - task.next_ms);
+      if (late_ms < 0) continue;
+      if (hungry && late_ms < task.deadline_ms && micros() - start_us + task.budget_us > (IDLE_TASK_SLICE)) continue;
+      task.next_ms = ms + task.period_ms;
+      task.run();
+    }
+  }
+
+#endif // IDLE_TASK_SCHEDULER
+
 /**
  * Standard idle routine keeps the machine alive
  */
 void idle(bool ignore_stepper_queue/*=false*/) {
-  manage_heater();
-  manage_inactivity(ignore_stepper_queue);
-  lcd_update();
+  #if ENABLED(REALTIME_COMMANDS)
+    realtime_commands();
+  #endif
+  #if HAS(BUZZER)
+    buzzer_tick();
+  #endif
+  #if ENABLED(AUTO_REPORT_STATUS)
+    auto_report_status();
+  #endif
+  #if ENABLED(REALTIME_OVERRIDES)
+    plan_feed_override();
+  #endif
+  #if ENABLED(POWER_LOSS_JOURNAL)
+    card.journalTick();
+  #endif
+  #if ENABLED(IDLE_TASK_SCHEDULER)
+    idle_ignore_stepper_queue = ignore_stepper_queue;
+    idle_scheduler();
+  #else
+    manage_heater();
+    manage_inactivity(ignore_stepper_queue);
+    lcd_update();
+  #endif
 }
 
 /**
@@ -8896,6 +9612,10 @@ void kill(const char* lcd_msg) {
     laser_init();
   #endif
 
+  #if ENABLED(LASER_RASTER_RESUME)
+    raster_resume_save(feedrate);
+  #endif
+
   #if ENABLED(LASER_PERIPHERALS)
     laser_peripherals_off();
   #endif
@@ -9003,6 +9723,9 @@ void Stop() {
   #ifdef LASER_PERIPHERALS
     laser_peripherals_off();
   #endif
+  #if ENABLED(LASER_RASTER_RESUME)
+    raster_resume_save(feedrate);
+  #endif
 
   if (IsRunning()) {
     Running = false;
@@ -196,6 +196,9 @@ extern int fanSpeed;
 
 #if ENABLED(LASERBEAM)
   extern int laser_ttl_modulation;
+  extern bool laser_pwr;
+  void laser_beam_sync();
+  void laser_beam_kill();
 #endif
 
 #if ENABLED(SDSUPPORT) && ENABLED(SD_SETTINGS)
@@ -1,13 +1,34 @@
+#include <avr/pgmspace.h>
 #include "Base64.h"
 
 const char b64_alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
 		"abcdefghijklmnopqrstuvwxyz"
 		"0123456789+/";
 
+/* Reverse alphabet, 0xFF marks padding, end of string and invalid digits */
+static const uint8_t b64_decode_table[256] PROGMEM = {
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x3E, 0xFF, 0xFF, 0xFF, 0x3F,
+	0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B, 0x3C, 0x3D, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E,
+	0x0F, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F, 0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28,
+	0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F, 0x30, 0x31, 0x32, 0x33, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF
+};
+
+#define B64_DIGIT(c) pgm_read_byte(&b64_decode_table[(uint8_t)(c)])
+
 /* 'Private' declarations */
 inline void a3_to_a4(int * a4, int * a3);
-inline void a4_to_a3(int * a3, int * a4);
-inline int b64_lookup(char c);
 
 int base64_encode(char *output, char *input, int inputLen) {
 	int i = 0, j = 0;
@@ -47,51 +68,31 @@ int base64_encode(char *output, char *input, int inputLen) {
 	return encLen;
 }
 
-//int base64_decode(unsigned char * output, char * input, int inputLen) {
-int base64_decode(int * output, char * input, int inputLen) {
-	int i = 0, j = 0;
-	int decLen = 0;
-	int a3[3];
-	int a4[4];
-
-
-	while (inputLen--) {
-		if(*input == '=') {
-			break;
-		}
-
-		a4[i++] = *(input++);
-		if (i == 4) {
-			for (i = 0; i <4; i++) {
-				a4[i] = b64_lookup(a4[i]);
-			}
-
-			a4_to_a3(a3,a4);
-
-			for (i = 0; i < 3; i++) {
-				output[decLen++] = a3[i];
-			}
-			i = 0;
-		}
+int base64_decode(uint8_t * output, char * input, int inputLen) {
+	uint8_t * out = output;
+
+	while (inputLen >= 4) {
+		uint8_t a = B64_DIGIT(input[0]), b = B64_DIGIT(input[1]),
+		        c = B64_DIGIT(input[2]), d = B64_DIGIT(input[3]);
+		if ((a | b | c | d) & 0x80) break;
+		*out++ = (a << 2) | (b >> 4);
+		*out++ = (b << 4) | (c >> 2);
+		*out++ = (c << 6) | d;
+		input += 4;
+		inputLen -= 4;
 	}
 
-	if (i) {
-		for (j = i; j < 4; j++) {
-			a4[j] = '\0';
-		}
-
-		for (j = 0; j <4; j++) {
-			a4[j] = b64_lookup(a4[j]);
-		}
-
-		a4_to_a3(a3,a4);
-
-		for (j = 0; j < i - 1; j++) {
-			output[decLen++] = a3[j];
+	/* Last 2 or 3 digits, before padding or the end of the input */
+	if (inputLen >= 2) {
+		uint8_t a = B64_DIGIT(input[0]), b = B64_DIGIT(input[1]);
+		if (!((a | b) & 0x80)) {
+			*out++ = (a << 2) | (b >> 4);
+			uint8_t c = inputLen >= 3 ? B64_DIGIT(input[2]) : 0xFF;
+			if (!(c & 0x80)) *out++ = (b << 4) | (c >> 2);
 		}
 	}
-	output[decLen] = '\0';
-	return decLen;
+
+	return out - output;
 }
 
 int base64_enc_len(int plainLen) {
@@ -115,19 +116,3 @@ inline void a3_to_a4(int * a4, int * a3) {
 	a4[2] = ((a3[1] & 0x0f) << 2) + ((a3[2] & 0xc0) >> 6);
 	a4[3] = (a3[2] & 0x3f);
 }
-
-inline void a4_to_a3(int * a3, int * a4) {
-	a3[0] = (a4[0] << 2) + ((a4[1] & 0x30) >> 4);
-	a3[1] = ((a4[1] & 0xf) << 4) + ((a4[2] & 0x3c) >> 2);
-	a3[2] = ((a4[2] & 0x3) << 6) + a4[3];
-}
-
-//inline unsigned char b64_lookup(char c) {
-inline int b64_lookup(char c) {
-	if(c >='A' && c <='Z') return c - 'A';
-	if(c >='a' && c <='z') return c - 71;
-	if(c >='0' && c <='9') return c + 4;
-	if(c == '+') return 62;
-	if(c == '/') return 63;
-	return -1;
-}
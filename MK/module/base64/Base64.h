@@ -5,6 +5,8 @@
 #ifndef _BASE64_H
 #define _BASE64_H
 
+#include <stdint.h>
+
 /* b64_alphabet:
  * 		Description: Base64 alphabet table, a mapping between integers
  * 					 and base64 digits
@@ -30,7 +32,9 @@ int base64_encode(char *output, char *input, int inputLen);
 
 /* base64_decode:
  * 		Description:
- * 			Decode a base64 encoded string into bytes
+ * 			Decode a base64 encoded string into bytes, 4 digits at a time.
+ * 			Decoding stops at padding, at the end of the string or at
+ * 			the first invalid digit
  * 		Parameters:
  * 			output: the output buffer for the decoding,
  * 					stores the decoded binary
@@ -44,8 +48,7 @@ int base64_encode(char *output, char *input, int inputLen);
  * 			2. input must not be null
  * 			3. inputLen must be greater than or equal to 0
  */
-//int base64_decode(unsigned char *output, char *input, int inputLen);
-int base64_decode(int *output, char *input, int inputLen);
+int base64_decode(uint8_t *output, char *input, int inputLen);
 /* base64_enc_len:
  * 		Description:
  * 			Returns the length of a base64 encoded string whose decoded
@@ -0,0 +1,76 @@
+/**
+ * Line number and checksum of a serial command, parsed while the characters arrive.
+ * No Arduino core needed, included by MK_Main.cpp and by the host tests in test/.
+ *
+ * serial_frame_add() gets every character get_command() keeps for the command,
+ * serial_frame_end_param() ends the line. Then serial_frame tells what the line had,
+ * serial_checksum is the XOR of the characters before '*' and serial_star_value the
+ * checksum sent by the host.
+ */
+#ifndef SERIAL_FRAME_H
+  #define SERIAL_FRAME_H
+
+  #include <stdint.h>
+
+  #define FRAME_STARTED 1 // a non blank character was received
+  #define FRAME_N       2 // the line starts with N<line number>
+  #define FRAME_M110    4 // M110 was received
+  #define FRAME_M110_N  8 // N<new line number> was received after M110
+  #define FRAME_STAR   16 // '*' was received, the following digits are the checksum
+  static uint8_t serial_frame = 0, serial_checksum = 0;
+  static char serial_param = 0; // parameter whose digits are being read: L(ine) N, M110 N, M or *
+  static long serial_param_value, serial_line_n, serial_m110_n, serial_star_value;
+
+  static void serial_frame_end_param() {
+    switch (serial_param) {
+      case 'L': serial_line_n = serial_param_value; serial_frame |= FRAME_N; break;
+      case 'N': serial_m110_n = serial_param_value; serial_frame |= FRAME_M110_N; break;
+      case 'M': if (serial_param_value == 110) serial_frame |= FRAME_M110; break;
+      case '*': serial_star_value = serial_param_value; break;
+    }
+    serial_param = 0;
+  }
+
+  /**
+   * Update line number and checksum with a character added to the command,
+   * so the complete line is validated without scanning it again.
+   */
+  static void serial_frame_add(const char c) {
+    if (serial_param) {
+      if (c >= '0' && c <= '9') {
+        serial_param_value = serial_param_value * 10 + (c - '0');
+        if (serial_param != '*') serial_checksum ^= c;
+        return;
+      }
+      serial_frame_end_param();
+    }
+
+    if (serial_frame & FRAME_STAR) return; // nothing is checked after the checksum
+
+    const bool first = !(serial_frame & FRAME_STARTED);
+    if (first) {
+      if (c == ' ') return; // leading spaces are skipped by the parser
+      serial_frame |= FRAME_STARTED;
+    }
+
+    switch (c) {
+      case '*':
+        serial_frame |= FRAME_STAR;
+        serial_param = '*';
+        serial_param_value = 0;
+        return;
+      case 'N':
+        if (first)
+          serial_param = 'L';
+        else if ((serial_frame & (FRAME_M110 | FRAME_M110_N)) == FRAME_M110)
+          serial_param = 'N';
+        break;
+      case 'M':
+        serial_param = 'M';
+        break;
+    }
+    if (serial_param) serial_param_value = 0;
+    serial_checksum ^= c;
+  }
+
+#endif // SERIAL_FRAME_H
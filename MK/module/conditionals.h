@@ -700,6 +700,7 @@
 #define HAS_POWER_SWITCH (POWER_SUPPLY > 0 && PIN_EXISTS(PS_ON))
 #define HAS_MOTOR_CURRENT_PWM_XY (PIN_EXISTS(MOTOR_CURRENT_PWM_XY))
 #define HAS_SDSUPPORT (ENABLED(SDSUPPORT))
+#define HAS_SD_POSITION (ENABLED(LASER_RASTER_RESUME) || ENABLED(POWER_LOSS_JOURNAL))
 
 #define HAS_DIGIPOTSS (PIN_EXISTS(DIGIPOTSS))
 
@@ -19,6 +19,7 @@
 
 #include "../../base.h"
 #include <avr/interrupt.h>
+#include <avr/eeprom.h>
 #include <Arduino.h>
 
 #if ENABLED(LASER)
@@ -86,6 +87,12 @@ void laser_init()
 
   // initialize state to some sane defaults
   laser.intensity = 100.0;
+  #ifdef LASER_POWER_RAMP
+    laser.intensity_end = -1;
+  #endif
+  #ifdef REALTIME_OVERRIDES
+    laser.power_scale = 256;
+  #endif
   laser.ppm = 0.0;
   laser.duration = 0;
   laser.status = LASER_OFF;
@@ -112,6 +119,7 @@ void laser_fire(int intensity = 100.0){
 	laser.last_firing = micros(); // microseconds of last laser firing
 	if (intensity > 10000.0) intensity = 10000.0; // restrict intensity between 0 and 10000 - These changes by Downunder35m allow for higher power resolution required for the raster engraving
 	if (intensity < 0) intensity = 0;
+	laser.firing_intensity = intensity;
 
     pinMode(LASER_FIRING_PIN, OUTPUT);
 	#if LASER_CONTROL == 1
@@ -152,6 +160,118 @@ void laser_set_mode(int mode){
 		  return;
 	}
 }
+#ifdef LASER_RASTER
+// Scale a raster pixel (0 - 255) to the laser intensity
+static int laser_raster_power(uint8_t pixel){
+	//http://stackoverflow.com/questions/929103/convert-a-number-range-to-another-range-maintaining-ratio
+	const int min_power = 750; // Min laser power for raster engraving, still needs to be included into the M649 command
+	int power = map(pixel, 0, 255, min_power, laser.rasterlaserpower); // Changed by Downunder35m as the original mapping resulted in a loss of CPU power due to the float calculations and the input range was set to 260 instead of 255 as otherwise total black areas would not come out properly.
+	if (power <= min_power) return 0; // turn off the tube below the minimum power
+	#ifdef LASER_POWER_CALIBRATION
+	  power = laser_calibrate(power);
+	#endif
+	return power;
+}
+// Decode a base64 raster line and scale it in one pass, 4 digits at a time
+int laser_raster_decode(int *pixels, char *input, int inputLen){
+	uint8_t quantum[3];
+	int count = 0;
+	while (inputLen > 0) {
+	  int n = base64_decode(quantum, input, inputLen < 4 ? inputLen : 4);
+	  for (int i = 0; i < n && count < LASER_MAX_RASTER_LINE; i++) pixels[count++] = laser_raster_power(quantum[i]);
+	  if (n < 3) break; // padding or end of the line
+	  input += 4;
+	  inputLen -= 4;
+	}
+	return count;
+}
+#endif // LASER_RASTER
+#ifdef LASER_RASTER_RESUME
+// Saved at the end of the EEPROM, away from the settings stored by M500
+#define RASTER_RESUME_VALID 0xA5
+#define RASTER_RESUME_EEPROM (E2END - sizeof(raster_resume_t))
+
+raster_resume_t raster_resume;
+
+// Called when an SD job starts from the beginning
+void raster_resume_start(){
+	CRITICAL_SECTION_START;
+	raster_resume.sdpos = 0;
+	raster_resume.line = 0;
+	CRITICAL_SECTION_END;
+	card.file.getFilename(raster_resume.filename);
+	raster_resume.filesize = card.fileSize;
+}
+// Keep the progress across a reset. Called by Stop() and kill(), only when a raster line was completed.
+void raster_resume_save(float feedrate){
+	if (!raster_resume.line) return;
+	CRITICAL_SECTION_START;
+	for (uint8_t i = X_AXIS; i <= Y_AXIS; i++) raster_resume.position[i] = raster_resume.steps[i] / axis_steps_per_unit[i];
+	CRITICAL_SECTION_END;
+	raster_resume.feedrate = feedrate;
+	raster_resume.raster_mm_per_pulse = laser.raster_mm_per_pulse;
+	raster_resume.rasterlaserpower = laser.rasterlaserpower;
+	raster_resume.raster_raw_length = laser.raster_raw_length;
+	eeprom_update_block(&raster_resume, (void*)RASTER_RESUME_EEPROM, sizeof(raster_resume));
+	eeprom_update_byte((uint8_t*)E2END, RASTER_RESUME_VALID);
+}
+// The job finished, nothing to resume
+void raster_resume_clear(){
+	raster_resume.line = 0;
+	eeprom_update_byte((uint8_t*)E2END, 0);
+}
+bool raster_resume_load(){
+	if (eeprom_read_byte((uint8_t*)E2END) != RASTER_RESUME_VALID) return false;
+	eeprom_read_block(&raster_resume, (void*)RASTER_RESUME_EEPROM, sizeof(raster_resume));
+	return true;
+}
+#endif // LASER_RASTER_RESUME
+#ifdef LASER_CURRENT_HISTOGRAM
+// Tube current sampled while firing, binned by the commanded intensity
+static volatile uint16_t current_count[LASER_CURRENT_BINS];
+static volatile uint32_t current_sum[LASER_CURRENT_BINS];
+
+void laser_current_sample(uint16_t raw){
+	if (laser.firing != LASER_ON) return;
+	uint8_t bin = ((uint32_t)laser.firing_intensity * LASER_CURRENT_BINS) / 10001;
+	if (current_count[bin] == 0xFFFF) return; // bin full, keep the average valid
+	current_count[bin]++;
+	current_sum[bin] += raw;
+}
+void laser_current_reset(){
+	CRITICAL_SECTION_START;
+	for (uint8_t i = 0; i < LASER_CURRENT_BINS; i++) {
+	  current_count[i] = 0;
+	  current_sum[i] = 0;
+	}
+	CRITICAL_SECTION_END;
+}
+// Same conversion as analog2current() for a single, not oversampled, reading
+static float laser_raw2current(float raw){
+	float volt = (5.0 * raw) / 1023.0 - POWER_ZERO;
+	if (volt < 0) volt = -volt;
+	float amps = (((100 - POWER_ERROR) / 100) * (volt / POWER_SENSITIVITY)) - POWER_OFFSET;
+	return amps > 0 ? amps : 0;
+}
+void laser_current_report(){
+	for (uint8_t i = 0; i < LASER_CURRENT_BINS; i++) {
+	  CRITICAL_SECTION_START;
+	  uint16_t count = current_count[i];
+	  uint32_t sum = current_sum[i];
+	  CRITICAL_SECTION_END;
+	  if (!count) continue;
+	  float raw = (float)sum / count;
+	  ECHO_SMV(DB, "S", (long)i * 10000 / LASER_CURRENT_BINS);
+	  ECHO_MV("-", (long)(i + 1) * 10000 / LASER_CURRENT_BINS - 1);
+	  ECHO_MV(" N:", count);
+	  ECHO_MV(" ADC:", raw);
+	  ECHO_EMV(" I:", laser_raw2current(raw), 3);
+	}
+}
+#endif // LASER_CURRENT_HISTOGRAM
+#ifdef LASER_POWER_CALIBRATION
+#include "laser_cal.h"
+#endif // LASER_POWER_CALIBRATION
 #ifdef LASER_PERIPHERALS
 bool laser_peripherals_ok(){
 	return !digitalRead(LASER_PERIPHERALS_STATUS_PIN);
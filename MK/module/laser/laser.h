@@ -27,18 +27,24 @@
 typedef struct {
   int fired; // method used to ask the laser to fire - LASER_FIRE_G1, LASER_FIRE_SPINDLE, LASER_FIRE_E, etc
   int intensity; // Laser firing instensity 0.0 - 100.0
+  #ifdef LASER_POWER_RAMP
+    int intensity_end; // intensity at the end of the move, -1 for constant intensity
+  #endif
   float ppm; // pulses per millimeter, for pulsed firing mode
   unsigned long duration; // laser firing duration in microseconds, for pulsed firing mode
   unsigned long dur; // instantaneous duration
   bool status; // LASER_ON / LASER_OFF - buffered
   bool firing; // LASER_ON / LASER_OFF - instantaneous
+  int firing_intensity; // intensity of the running laser_fire(), 0 - 10000
+  #ifdef REALTIME_OVERRIDES
+    unsigned int power_scale; // power override applied by the stepper ISR, 256 = 100%
+  #endif
   uint8_t mode; // CONTINUOUS, PULSED, RASTER
   unsigned long last_firing; // microseconds since last laser firing
   bool diagnostics; // Verbose debugging output over serial
   unsigned int time; // temporary counter to limit eeprom writes
   unsigned int lifetime; // laser lifetime firing counter in minutes
   #ifdef LASER_RASTER
-    int raster_data[LASER_MAX_RASTER_LINE];
     int rasterlaserpower;
 
     float raster_aspect_ratio;
@@ -61,6 +67,43 @@ void laser_fire(int intensity);
 void laser_extinguish();
 void laser_update_lifetime();
 void laser_set_mode(int mode);
+#ifdef LASER_RASTER
+  int laser_raster_decode(int *pixels, char *input, int inputLen);
+#endif // LASER_RASTER
+#ifdef LASER_RASTER_RESUME
+  // Progress of the running SD raster job, the line fields are updated by the stepper ISR
+  typedef struct {
+    char filename[13];          // short name and size of the job file identify the image
+    uint32_t filesize;
+    volatile uint32_t sdpos;    // file position after the last completed raster line
+    volatile uint16_t line;     // completed raster lines
+    volatile long steps[2];     // X and Y of the head at the end of that line
+    float position[2];          // steps converted to mm when saved
+    float feedrate;
+    float raster_mm_per_pulse;
+    int rasterlaserpower;
+    int raster_raw_length;
+    volatile bool raster_direction; // X direction of that line, the parser's may be lines ahead
+  } raster_resume_t;
+
+  extern raster_resume_t raster_resume;
+  void raster_resume_start();
+  void raster_resume_save(float feedrate);
+  void raster_resume_clear();
+  bool raster_resume_load();
+#endif // LASER_RASTER_RESUME
+#ifdef LASER_CURRENT_HISTOGRAM
+  void laser_current_sample(uint16_t raw); // called by the temperature ISR
+  void laser_current_reset();
+  void laser_current_report();
+#endif // LASER_CURRENT_HISTOGRAM
+#ifdef LASER_POWER_CALIBRATION
+  extern int laser_cal_curve[LASER_CAL_POINTS]; // output intensity for evenly spaced requested intensities
+  void laser_cal_reset();
+  int laser_calibrate(int intensity);
+  int laser_uncalibrate(int output);
+  bool laser_cal_fit(float response[]);
+#endif // LASER_POWER_CALIBRATION
 #ifdef LASER_PERIPHERALS
   bool laser_peripherals_ok();
   void laser_peripherals_on();
@@ -0,0 +1,65 @@
+/*
+  laser_cal.h - Laser power calibration curve
+
+  Plain arithmetic, included once by laser.cpp and by the host tests in test/.
+  Needs LASER_CAL_POINTS and the Arduino constrain() macro.
+*/
+#ifndef LASER_CAL_H
+#define LASER_CAL_H
+
+#include <stdint.h>
+#include <math.h>
+
+int laser_cal_curve[LASER_CAL_POINTS];
+
+void laser_cal_reset(){
+	for (uint8_t i = 0; i < LASER_CAL_POINTS; i++) laser_cal_curve[i] = (long)i * 10000 / (LASER_CAL_POINTS - 1);
+}
+// Map a requested intensity to the intensity sent to laser_fire(), linear between curve points
+int laser_calibrate(int intensity){
+	if (intensity <= 0) return 0;
+	if (intensity >= 10000) return laser_cal_curve[LASER_CAL_POINTS - 1];
+	long pos = (long)intensity * (LASER_CAL_POINTS - 1);
+	uint8_t i = pos / 10000;
+	long frac = pos % 10000;
+	return laser_cal_curve[i] + ((laser_cal_curve[i + 1] - laser_cal_curve[i]) * frac) / 10000;
+}
+// Inverse of laser_calibrate(), gives the requested intensity back from a planned block
+int laser_uncalibrate(int output){
+	uint8_t i = 0;
+	while (i < LASER_CAL_POINTS - 2 && laser_cal_curve[i + 1] < output) i++;
+	long span = laser_cal_curve[i + 1] - laser_cal_curve[i],
+	     base = (long)i * 10000 / (LASER_CAL_POINTS - 1);
+	if (span <= 0) return base;
+	long intensity = base + ((long)(output - laser_cal_curve[i]) * 10000) / (span * (LASER_CAL_POINTS - 1));
+	return constrain(intensity, 0, 10000);
+}
+/**
+ * Fit the curve from the response measured at evenly spaced output intensities
+ * (response[i] measured at i * 10000 / (LASER_CAL_POINTS - 1)). The response is
+ * made monotone, then inverted so that a request of j / (LASER_CAL_POINTS - 1)
+ * of full power gets the same fraction of the full power response.
+ * Plain arithmetic only, so it can be built and checked on a host.
+ */
+bool laser_cal_fit(float response[]){
+	for (uint8_t i = 1; i < LASER_CAL_POINTS; i++)
+	  if (response[i] < response[i - 1]) response[i] = response[i - 1];
+
+	float full = response[LASER_CAL_POINTS - 1];
+	if (full <= response[0]) return false; // no response at all, keep the curve
+
+	uint8_t k = 0;
+	laser_cal_curve[0] = 0;
+	for (uint8_t j = 1; j < LASER_CAL_POINTS; j++) {
+	  float target = full * j / (LASER_CAL_POINTS - 1);
+	  while (k < LASER_CAL_POINTS - 2 && response[k + 1] < target) k++;
+	  float span = response[k + 1] - response[k],
+	        out = (float)k * 10000 / (LASER_CAL_POINTS - 1);
+	  if (span > 0 && target > response[k])
+	    out += (float)10000 / (LASER_CAL_POINTS - 1) * (target - response[k]) / span;
+	  laser_cal_curve[j] = constrain(lround(out), laser_cal_curve[j - 1], 10000);
+	}
+	return true;
+}
+
+#endif // LASER_CAL_H
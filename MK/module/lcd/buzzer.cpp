@@ -3,32 +3,69 @@
 #if HAS(BUZZER)
   #include "buzzer.h"
 
+  typedef struct {
+    uint16_t duration;
+    uint16_t freq;
+  } note_t;
+
+  static note_t buzzer_queue[BUZZER_QUEUE_SIZE];
+  static volatile uint8_t buzzer_head = 0, buzzer_tail = 0;
+  static bool buzzer_playing = false;
+  static millis_t buzzer_end_ms = 0;
+
+  #define BUZZER_NEXT(i) (((i) + 1) & (BUZZER_QUEUE_SIZE - 1))
+
+  bool buzzer_queue_full() { return BUZZER_NEXT(buzzer_head) == buzzer_tail; }
+
   void buzz(long duration, uint16_t freq) {
-    if (freq > 0) {
-      #if ENABLED(LCD_USE_I2C_BUZZER)
-        lcd_buzz(duration, freq);
-      #elif PIN_EXISTS(BEEPER) // on-board buzzers have no further condition
-        SET_OUTPUT(BEEPER_PIN);
-        #if ENABLED(SPEAKER) // a speaker needs a AC ore a pulsed DC
-          //tone(BEEPER_PIN, freq, duration); // needs a PWMable pin
-          unsigned int delay = 1000000 / freq / 2;
-          int i = duration * freq / 1000;
-          while (i--) {
-            WRITE(BEEPER_PIN, HIGH);
-            HAL::delayMicroseconds(delay);
-            WRITE(BEEPER_PIN, LOW);
-            HAL::delayMicroseconds(delay);
-          }
-        #else // buzzer has its own resonator - needs a DC
-          tone(BEEPER_PIN, freq, duration);
-          HAL::delayMilliseconds(1 + duration);
-        #endif
-      #else
-        HAL::delayMilliseconds(duration);
+    if (duration <= 0 || buzzer_queue_full()) return;
+    note_t &note = buzzer_queue[buzzer_head];
+    note.duration = min(duration, 0xFFFFL);
+    note.freq = freq;
+    buzzer_head = BUZZER_NEXT(buzzer_head);
+  }
+
+  static void buzzer_off() {
+    #if ENABLED(LCD_USE_I2C_BUZZER)
+      // The LCD plays the whole note by itself
+    #elif PIN_EXISTS(BEEPER)
+      #if ENABLED(SPEAKER)
+        noTone(BEEPER_PIN);
       #endif
+      WRITE(BEEPER_PIN, LOW);
+    #endif
+  }
+
+  static void buzzer_on(const note_t &note) {
+    if (note.freq == 0) return; // pause
+    #if ENABLED(LCD_USE_I2C_BUZZER)
+      lcd_buzz(note.duration, note.freq);
+    #elif PIN_EXISTS(BEEPER) // on-board buzzers have no further condition
+      SET_OUTPUT(BEEPER_PIN);
+      #if ENABLED(SPEAKER) // a speaker needs a AC ore a pulsed DC
+        tone(BEEPER_PIN, note.freq, note.duration);
+      #else // buzzer has its own resonator - needs a DC
+        WRITE(BEEPER_PIN, HIGH);
+      #endif
+    #endif
+  }
+
+  void buzzer_tick() {
+    millis_t ms = millis();
+
+    if (buzzer_playing) {
+      if ((long)(ms - buzzer_end_ms) < 0) return;
+      buzzer_off();
+      buzzer_playing = false;
     }
-    else {
-      HAL::delayMilliseconds(duration);
-    }
+
+    if (buzzer_tail == buzzer_head) return;
+
+    const note_t &note = buzzer_queue[buzzer_tail];
+    buzzer_on(note);
+    buzzer_end_ms = ms + note.duration;
+    buzzer_playing = true;
+    buzzer_tail = BUZZER_NEXT(buzzer_tail);
   }
+
 #endif
@@ -2,7 +2,20 @@
   #define BUZZER_H
 
   #if HAS(BUZZER)
+
+    #define BUZZER_QUEUE_SIZE 4 // Notes waiting to be played, must be a power of 2
+
+    /**
+     * Queue a note and return at once. A zero freq is a pause.
+     * The note is dropped if the queue is full.
+     */
     void buzz(long duration, uint16_t freq);
+
+    // Start and stop the queued notes, called from idle()
+    void buzzer_tick();
+
+    bool buzzer_queue_full();
+
   #endif
 
 #endif // BUZZER_H
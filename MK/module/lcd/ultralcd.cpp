@@ -851,6 +851,14 @@ void lcd_cooldown() {
   lcd_return_to_status();
 }
 
+#if ENABLED(LASERBEAM)
+  // The edited power goes with the next planned move, like M3
+  static void lcd_laser_beam_changed() {
+    laser_pwr = (laser_ttl_modulation != 0);
+    laser_beam_sync();
+  }
+#endif
+
 /**
  *
  * "Prepare" submenu
@@ -931,13 +939,7 @@ static void lcd_prepare_menu() {
   // LASER BEAM
   //
   #if ENABLED(LASERBEAM)
-    MENU_ITEM_EDIT(int3, MSG_LASER, &laser_ttl_modulation, 0, 255);
-    if(laser_ttl_modulation == 0) {
-      WRITE(LASER_PWR_PIN, LOW);
-    }
-    else {
-      WRITE(LASER_PWR_PIN, HIGH);
-    }
+    MENU_ITEM_EDIT_CALLBACK(int3, MSG_LASER, &laser_ttl_modulation, 0, 255, lcd_laser_beam_changed);
   #endif
 
   //
@@ -105,6 +105,10 @@ static float previous_nominal_speed;   // Nominal speed of previous path line se
 
 uint8_t g_uc_extruder_last_move[EXTRUDERS] = { 0 };
 
+#if ENABLED(REALTIME_OVERRIDES)
+  int plan_feed_multiplier = 0; // feedrate_multiplier contained in the feed_rate of plan_buffer_line(), 0 if none
+#endif
+
 #if ENABLED(XY_FREQUENCY_LIMIT)
   // Used for the frequency limit
   #define MAX_FREQ_TIME (1000000.0/XY_FREQUENCY_LIMIT)
@@ -148,9 +152,17 @@ FORCE_INLINE float intersection_distance(float initial_rate, float final_rate, f
   return (acceleration * 2 * distance - initial_rate * initial_rate + final_rate * final_rate) / (acceleration * 4);
 }
 
+#if ENABLED(S_CURVE_ACCELERATION)
+  #include "s_curve.h"
+#endif
+
 // Calculates trapezoid parameters so that the entry- and exit-speed is compensated by the provided factors.
 
 void calculate_trapezoid_for_block(block_t* block, float entry_factor, float exit_factor) {
+  #if ENABLED(PLANNER_DWELL)
+    if (block->dwell) return; // fixed rate, set by plan_buffer_dwell()
+  #endif
+
   unsigned long initial_rate = ceil(block->nominal_rate * entry_factor); // (step/min)
   unsigned long final_rate = ceil(block->nominal_rate * exit_factor); // (step/min)
 
@@ -180,6 +192,17 @@ void calculate_trapezoid_for_block(block_t* block, float entry_factor, float exi
     volatile long final_advance = block->advance * exit_factor * exit_factor;
   #endif // ADVANCE
 
+  #if ENABLED(S_CURVE_ACCELERATION)
+    // The S-curve covers the same distance as the linear ramp in the same time,
+    // so accelerate_until and decelerate_after stay valid. The stepper only needs
+    // the speed change of each ramp, as the scale of the ramp's progress.
+    unsigned long peak_rate = block->nominal_rate;
+    if (plateau_steps == 0)
+      NOMORE(peak_rate, (unsigned long)sqrt(sq((float)initial_rate) + 2.0 * acceleration * accelerate_steps));
+    unsigned long accel_curve = s_curve_factor(peak_rate, initial_rate),
+                  decel_curve = s_curve_factor(peak_rate, final_rate);
+  #endif
+
   // block->accelerate_until = accelerate_steps;
   // block->decelerate_after = accelerate_steps+plateau_steps;
   CRITICAL_SECTION_START;  // Fill variables used by the stepper in a critical section
@@ -192,6 +215,11 @@ void calculate_trapezoid_for_block(block_t* block, float entry_factor, float exi
       block->initial_advance = initial_advance;
       block->final_advance = final_advance;
     #endif
+    #if ENABLED(S_CURVE_ACCELERATION)
+      block->peak_rate = peak_rate;
+      block->accel_curve = accel_curve;
+      block->decel_curve = decel_curve;
+    #endif
   }
   CRITICAL_SECTION_END;
 }
@@ -395,9 +423,6 @@ void check_axes_activity() {
     unsigned char tail_valve_pressure = ValvePressure,
                   tail_e_to_p_pressure = EtoPPressure;
   #endif
-  #if ENABLED(LASERBEAM)
-    unsigned char tail_laser_ttl_modulation = laser_ttl_modulation;
-  #endif
   block_t* block;
 
   if (blocks_queued()) {
@@ -408,9 +433,6 @@ void check_axes_activity() {
       tail_valve_pressure = block->valve_pressure;
       tail_e_to_p_pressure = block->e_to_p_pressure;
     #endif
-    #if ENABLED(LASERBEAM)
-      tail_laser_ttl_modulation = block_buffer[block_index].laser_ttlmodulation;
-    #endif
 
     while (block_index != block_buffer_head) {
       block = &block_buffer[block_index];
@@ -470,13 +492,43 @@ void check_axes_activity() {
       analogWrite(HEATER_2_PIN, tail_e_to_p_pressure);
     #endif
   #endif
-
-  // add Laser TTL Modulation(PWM) Control
-  #if ENABLED(LASERBEAM)
-    analogWrite(LASER_TTL_PIN, tail_laser_ttl_modulation);
-  #endif
 }
 
+#if ENABLED(LASER_RASTER)
+  static int* raster_slot = NULL;
+
+  // Pixels of the block the next plan_buffer_line() fills. The ISR doesn't
+  // touch that block before it is queued, so G7 decodes straight into it.
+  int* plan_raster_slot() {
+    while (block_buffer_tail == next_block_index(block_buffer_head)) idle();
+    return raster_slot = block_buffer[block_buffer_head].laser_raster_data;
+  }
+#endif
+
+#if ENABLED(LASERBEAM)
+  // Clear the beam in the planned blocks, so a block that starts later can't switch it on again
+  void plan_laser_beam_off() {
+    CRITICAL_SECTION_START;
+    for (int8_t i = block_buffer_tail; i != block_buffer_head; i = next_block_index(i)) {
+      block_buffer[i].laser_pwr = false;
+      block_buffer[i].laser_ttlmodulation = 0;
+    }
+    CRITICAL_SECTION_END;
+  }
+#endif
+
+#if HAS(SD_POSITION)
+  // Tag the last block a command planned with the SD position after that command.
+  // head is block_buffer_head from before the command, nothing is tagged if it
+  // didn't plan a move. The block may be running already, hence the critical section.
+  void plan_set_sdpos(uint8_t head, uint32_t sdpos) {
+    if (head == block_buffer_head) return;
+    CRITICAL_SECTION_START;
+    block_buffer[prev_block_index(block_buffer_head)].sdpos = sdpos;
+    CRITICAL_SECTION_END;
+  }
+#endif
+
 float junction_deviation = 0.1;
 // Add a new linear movement to the buffer. steps[X_AXIS], _y and _z is the absolute position in
 // mm. Microseconds specify how many microseconds the move should take to perform. To aid acceleration
@@ -504,6 +556,11 @@ float junction_deviation = 0.1;
   // Rest here until there is room in the buffer.
   while (block_buffer_tail == next_buffer_head) idle();
 
+  #if ENABLED(REALTIME_COMMANDS)
+    // A laser kill from the serial line emptied the buffer while we waited
+    if (!IsRunning()) return;
+  #endif
+
   #if ENABLED(AUTO_BED_LEVELING_FEATURE)
     apply_rotation_xyz(plan_bed_level_matrix, x, y, z);
   #endif
@@ -582,6 +639,14 @@ float junction_deviation = 0.1;
   // Mark block as not busy (Not executed by the stepper interrupt)
   block->busy = false;
 
+  #if HAS(SD_POSITION)
+    block->sdpos = 0;
+  #endif
+
+  #if ENABLED(PLANNER_DWELL)
+    block->dwell = false;
+  #endif
+
   // Number of steps for each axis
   #if MECH(COREXY) || MECH(COREYX)
     // corexy planning
@@ -627,6 +692,7 @@ float junction_deviation = 0.1;
   // Add update block variables for LASER BEAM control 
   #if ENABLED(LASERBEAM)
     block->laser_ttlmodulation = laser_ttl_modulation;
+    block->laser_pwr = laser_pwr;
   #endif
 
   // Compute direction bits for this block 
@@ -860,7 +926,11 @@ float junction_deviation = 0.1;
   }
 
   #if ENABLED(LASER)
-   block->laser_intensity = laser.intensity;
+   #if ENABLED(LASER_POWER_CALIBRATION)
+     block->laser_intensity = laser_calibrate(laser.intensity);
+   #else
+     block->laser_intensity = laser.intensity;
+   #endif
    block->laser_duration = laser.duration;
    block->laser_status = laser.status;
    block->laser_mode = laser.mode;
@@ -868,36 +938,43 @@ float junction_deviation = 0.1;
     // Calculate steps between laser firings (steps_l) and consider that when determining largest
     // interval between steps for X, Y, Z, E, L to feed to the motion control code.
     if (laser.mode == RASTER || laser.mode == PULSED) {
+        #if ENABLED(LASER_RASTER)
+          // Raster lines fire exactly one pulse per pixel, the stepper spreads them evenly over the
+          // step events. Deriving the count from the length could lose a pixel to rounding.
+          if (laser.mode == RASTER)
+            block->steps_l = laser.raster_num_pixels;
+          else
+        #endif
         block->steps_l = labs(block->millimeters*laser.ppm);
-       for (int i = 0; i < LASER_MAX_RASTER_LINE; i++) {
-
-            //Scale the image intensity based on the raster power.
-         //100% power on a pixel basis is 255, convert back to 255 = 100.
-
-        //http://stackoverflow.com/questions/929103/convert-a-number-range-to-another-range-maintaining-ratio
-            int OldRange, NewRange, NewMin;
-            //float NewValue;
-            NewMin = 750; // Min laser power for raster engraving, still needs to be included into the M649 command
-            //OldRange = (255 - 0);
-            //NewRange = (laser.rasterlaserpower - NewMin); //7% power on my unit outputs hardly any noticable burn at F3000 on paper, so adjust the raster contrast based off 7 being the lower. 7 still produces burns at slower feed rates, but getting less power than this isn't typically needed at slow feed rates.
-            //NewValue = (float)(((((float)laser.raster_data[i] - 0) * NewRange) / OldRange) + 70);
-            //NewValue = ((((laser.raster_data[i] - 0) * NewRange) / OldRange) + NewMin);
-            //If less than 7%, turn off the laser tube.
-            //if(NewValue == 280) 
-            //	NewValue = 0;
-            int NewValue = laser.raster_data[i];
-            NewValue = map(NewValue, 0 ,255, NewMin, laser.rasterlaserpower); // Changed by Downunder35m as the original mapping resulted in a loss of CPU power due to the float calculations and the input range was set to 260 instead of 255 as otherwise total black areas would not come out properly.
-            if(NewValue <= NewMin)
-            NewValue = 0;
-            
-            block->laser_raster_data[i] = NewValue; 
-        }
+        #if ENABLED(LASER_RASTER)
+          // G7 decoded the pixels straight into this block, see plan_raster_slot()
+          if (laser.mode == RASTER && raster_slot) {
+            if (raster_slot != block->laser_raster_data)
+              memcpy(block->laser_raster_data, raster_slot, laser.raster_num_pixels * sizeof(*raster_slot)); // another block took the slot
+            raster_slot = NULL; // used up, its block may be recycled before the next G7 D
+          }
+        #endif
     } else {
         block->steps_l = 0;
     }
+    #if ENABLED(LASER_POWER_RAMP)
+      block->laser_ramp = 0;
+      block->laser_ramp_start = laser.intensity;
+      if (laser.intensity_end >= 0 && laser.mode == CONTINUOUS && laser.status == LASER_ON) {
+        // Linear in the requested power, the calibration is applied to every step of the ramp
+        long step_events = max(block->steps[X_AXIS], max(block->steps[Y_AXIS], max(block->steps[Z_AXIS], block->steps[E_AXIS]))); // steps_l is 0 in continuous mode
+        if (step_events) block->laser_ramp = (((long)laser.intensity_end - laser.intensity) << 16) / step_events;
+      }
+    #endif
     // NEXTIME
     block->step_event_count = max(block->steps[X_AXIS], max(block->steps[Y_AXIS], max(block->steps[Z_AXIS], max(block->steps[E_AXIS], block->steps_l))));
 
+    // Pulse spacing as a fraction of a pulse per step event, so the stepper can
+    // carry the pulse phase from block to block instead of restarting it
+    block->laser_pulse_rate = 0;
+    if (laser.mode == PULSED && block->step_event_count)
+      block->laser_pulse_rate = min(lround(block->millimeters * laser.ppm * 65536.0 / block->step_event_count), 65536L);
+
     if (laser.diagnostics) {
       if (block->laser_status == LASER_ON) {
          ECHO_LM(INFO, "Laser firing enabled");
@@ -1010,6 +1087,11 @@ float junction_deviation = 0.1;
     }
   #endif // XY_FREQUENCY_LIMIT
 
+  #if ENABLED(REALTIME_OVERRIDES)
+    // The requested speed, plan_feed_override() applies max_feedrate again for the new feed
+    block->feed_base = plan_feed_multiplier ? block->nominal_speed * 100 / plan_feed_multiplier : 0;
+  #endif
+
   // Correct the speed
   if (speed_factor < 1.0) {
     for (unsigned char i = 0; i < NUM_AXIS; i++) current_speed[i] *= speed_factor;
@@ -1116,6 +1198,9 @@ float junction_deviation = 0.1;
     vmax_junction = min(previous_nominal_speed, vmax_junction * vmax_junction_factor); // Limit speed to max previous speed
   }
   block->max_entry_speed = vmax_junction;
+  #if ENABLED(REALTIME_OVERRIDES)
+    block->max_entry_base = plan_feed_multiplier ? vmax_junction * 100 / plan_feed_multiplier : 0;
+  #endif
 
   // Initialize block entry speed. Compute based on deceleration to user-defined MINIMUM_PLANNER_SPEED.
   double v_allowable = max_allowable_speed(-block->acceleration, MINIMUM_PLANNER_SPEED, block->millimeters);
@@ -1168,6 +1253,130 @@ float junction_deviation = 0.1;
 
 } // plan_buffer_line()
 
+#if ENABLED(REALTIME_OVERRIDES)
+  /**
+   * Apply a changed feedrate_multiplier (M220, LCD) to the blocks the stepper
+   * hasn't started yet, so it acts after the running block instead of after
+   * the whole buffer. The first waiting block keeps its entry speed, the
+   * running block already decelerates to it. Called from idle().
+   */
+  void plan_feed_override() {
+    static int last_multiplier = 100;
+    if (feedrate_multiplier == last_multiplier) return;
+    last_multiplier = feedrate_multiplier;
+
+    uint8_t first = block_buffer_tail, head = block_buffer_head;
+    if (first != head && block_buffer[first].busy) first = next_block_index(first);
+    if (first == head) return;
+
+    bool changed = false;
+    for (uint8_t block_index = first; block_index != head; block_index = next_block_index(block_index)) {
+      block_t* block = &block_buffer[block_index];
+      if (!block->feed_base) continue;
+
+      float nominal_speed = block->feed_base * feedrate_multiplier / 100;
+      for (uint8_t i = X_AXIS; i <= Z_AXIS; i++)
+        if (block->steps[i]) NOMORE(nominal_speed, max_feedrate[i] * block->millimeters * axis_steps_per_unit[i] / block->steps[i]);
+      if (block_index == first) NOLESS(nominal_speed, block->entry_speed);
+
+      CRITICAL_SECTION_START;
+      if (!block->busy) {
+        block->nominal_speed = nominal_speed;
+        block->nominal_rate = ceil(block->step_event_count * nominal_speed / block->millimeters);
+        block->nominal_length_flag = (nominal_speed <= max_allowable_speed(-block->acceleration, MINIMUM_PLANNER_SPEED, block->millimeters));
+      }
+      CRITICAL_SECTION_END;
+      changed = true;
+    }
+    if (!changed) return;
+
+    // The next planned move joins the last block at its new speed
+    block_t* last = &block_buffer[prev_block_index(head)];
+    if (last->feed_base && previous_nominal_speed > 0.0) {
+      float factor = last->nominal_speed / previous_nominal_speed;
+      for (uint8_t i = 0; i < NUM_AXIS; i++) previous_speed[i] *= factor;
+      previous_nominal_speed = last->nominal_speed;
+    }
+
+    // Reverse pass over the waiting blocks, junction limits follow the feed but never exceed both neighbours
+    float next_entry_speed = MINIMUM_PLANNER_SPEED;
+    uint8_t block_index = head;
+    while (block_index != first) {
+      block_index = prev_block_index(block_index);
+      block_t* block = &block_buffer[block_index];
+      if (block_index != first) {
+        float junction_speed = min(block->nominal_speed, block_buffer[prev_block_index(block_index)].nominal_speed);
+        if (block->feed_base) block->max_entry_speed = min(block->max_entry_base * feedrate_multiplier / 100, junction_speed);
+        else NOMORE(block->max_entry_speed, junction_speed);
+        block->entry_speed = min(block->max_entry_speed, max_allowable_speed(-block->acceleration, next_entry_speed, block->millimeters));
+      }
+      block->recalculate_flag = true;
+      next_entry_speed = block->entry_speed;
+    }
+
+    planner_forward_pass();
+    planner_recalculate_trapezoids();
+  }
+#endif
+
+#if ENABLED(PLANNER_DWELL)
+  /**
+   * Queue a dwell of ms milliseconds: a block without steps that the stepper
+   * runs at one step event per millisecond. Its entry speed is zero, so the
+   * moves before it stop and the moves after it start from rest. Fans and
+   * the laser keep the state they have when the dwell is planned.
+   */
+  void plan_buffer_dwell(millis_t ms) {
+    if (!ms) return;
+
+    int next_buffer_head = next_block_index(block_buffer_head);
+    while (block_buffer_tail == next_buffer_head) idle();
+
+    #if ENABLED(REALTIME_COMMANDS)
+      if (!IsRunning()) return;
+    #endif
+
+    block_t* block = &block_buffer[block_buffer_head];
+    uint8_t direction_bits = block_buffer[prev_block_index(block_buffer_head)].direction_bits;
+    memset(block, 0, sizeof(*block));
+
+    block->dwell = true;
+    block->direction_bits = direction_bits; // leave the direction pins alone
+    block->step_event_count = ms;
+    block->nominal_rate = block->initial_rate = block->final_rate = 1000;
+    block->decelerate_after = ms;
+    block->recalculate_flag = true; // the move before decelerates to the dwell
+    block->fan_speed = fanSpeed;
+
+    #if ENABLED(BARICUDA)
+      block->valve_pressure = ValvePressure;
+      block->e_to_p_pressure = EtoPPressure;
+    #endif
+
+    #if ENABLED(LASER)
+      #if ENABLED(LASER_POWER_CALIBRATION)
+        block->laser_intensity = laser_calibrate(laser.intensity);
+      #else
+        block->laser_intensity = laser.intensity;
+      #endif
+      block->laser_status = laser.status;
+      block->laser_mode = CONTINUOUS;
+    #endif
+
+    #if ENABLED(LASERBEAM)
+      block->laser_ttlmodulation = laser_ttl_modulation;
+      block->laser_pwr = laser_pwr;
+    #endif
+
+    block_buffer_head = next_buffer_head;
+    previous_nominal_speed = 0.0; // the next move starts from rest
+
+    planner_recalculate();
+
+    st_wake_up();
+  }
+#endif
+
 #if ENABLED(AUTO_BED_LEVELING_FEATURE)
   vector_3 plan_get_position() {
     vector_3 position = vector_3(st_get_axis_position_mm(X_AXIS), st_get_axis_position_mm(Y_AXIS), st_get_axis_position_mm(Z_AXIS));
@@ -57,14 +57,30 @@ typedef struct {
   float acceleration;                                // acceleration mm/sec^2
   unsigned char recalculate_flag;                    // Planner flag to recalculate trapezoids on entry junction
   unsigned char nominal_length_flag;                 // Planner flag for nominal speed always reached
+  #if ENABLED(REALTIME_OVERRIDES)
+    float feed_base;                                 // nominal_speed at 100% feed, 0 if the override doesn't apply
+    float max_entry_base;                            // max_entry_speed at 100% feed
+  #endif
+  #if ENABLED(PLANNER_DWELL)
+    bool dwell;                                      // No steps, one step event per millisecond of dwell
+  #endif
 
   // Settings for the trapezoid generator
   unsigned long nominal_rate;                        // The nominal step rate for this block in step_events/sec
   unsigned long initial_rate;                        // The jerk-adjusted step rate at start of block
   unsigned long final_rate;                          // The minimal rate at exit
   unsigned long acceleration_st;                     // acceleration steps/sec^2
+  #if ENABLED(S_CURVE_ACCELERATION)
+    unsigned short peak_rate;                        // The step rate where acceleration ends, nominal_rate or less
+    unsigned long accel_curve;                       // 2^40 / (peak_rate - initial_rate), 0 for a linear ramp
+    unsigned long decel_curve;                       // 2^40 / (peak_rate - final_rate), 0 for a linear ramp
+  #endif
   unsigned long fan_speed;
 
+  #if HAS(SD_POSITION)
+    uint32_t sdpos; // SD position after the command that planned this block as its last one, 0 if none
+  #endif
+
   #if ENABLED(BARICUDA)
     unsigned long valve_pressure;
     unsigned long e_to_p_pressure;
@@ -76,7 +92,12 @@ typedef struct {
     float laser_ppm; // pulses per millimeter, for pulsed and raster firing modes
     unsigned long laser_duration; // laser firing duration in microseconds, for pulsed and raster firing modes
     long steps_l; // step count between firings of the laser, for pulsed firing mode
+    long laser_pulse_rate; // pulses per step event, 16.16 fixed point, for pulsed firing mode
     int laser_intensity; // Laser firing instensity in clock cycles for the PWM timer
+    #if ENABLED(LASER_POWER_RAMP)
+      long laser_ramp; // requested intensity change per step event, 16.16 fixed point
+      int laser_ramp_start; // requested intensity at the start, the stepper calibrates it as it ramps
+    #endif
     #if ENABLED(LASER_RASTER)
        //unsigned char laser_raster_data[LASER_MAX_RASTER_LINE]; 
 	  int laser_raster_data[LASER_MAX_RASTER_LINE]; // Changed by Downunder35m to int to allow for the greater power input range, also changed the base64 files to use integer where it matters.
@@ -85,6 +106,7 @@ typedef struct {
 
   #if ENABLED(LASERBEAM)
     unsigned long laser_ttlmodulation;
+    bool laser_pwr; // LASER_PWR_PIN state, set when the block starts
   #endif
 
   volatile char busy;
@@ -166,6 +188,27 @@ extern block_t block_buffer[BLOCK_BUFFER_SIZE];            // A ring buffer for
 extern volatile unsigned char block_buffer_head;           // Index of the next block to be pushed
 extern volatile unsigned char block_buffer_tail;
 
+#if ENABLED(LASER_RASTER)
+  int* plan_raster_slot();
+#endif
+
+#if ENABLED(LASERBEAM)
+  void plan_laser_beam_off();
+#endif
+
+#if HAS(SD_POSITION)
+  void plan_set_sdpos(uint8_t head, uint32_t sdpos);
+#endif
+
+#if ENABLED(PLANNER_DWELL)
+  void plan_buffer_dwell(millis_t ms);
+#endif
+
+#if ENABLED(REALTIME_OVERRIDES)
+  extern int plan_feed_multiplier;
+  void plan_feed_override();
+#endif
+
 // Returns true if the buffer has a queued block, false otherwise
 FORCE_INLINE bool blocks_queued() { return (block_buffer_head != block_buffer_tail); }
 
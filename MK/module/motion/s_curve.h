@@ -0,0 +1,32 @@
+/**
+ * S-curve acceleration (S_CURVE_ACCELERATION), fixed point parts shared by
+ * the planner and the stepper ISR. No Arduino core needed, the host tests
+ * in test/ build it with a C version of MultiU24X32toH16.
+ */
+#ifndef S_CURVE_H
+  #define S_CURVE_H
+
+  // 2^40 / change, the stepper's fixed point scale for a ramp of change steps/s.
+  // Ramps of 256 steps/s or less stay linear (0), their jerk doesn't matter.
+  FORCE_INLINE unsigned long s_curve_factor(unsigned long peak_rate, unsigned long end_rate) {
+    return peak_rate > end_rate + 256 ? 1099511627776.0 / (peak_rate - end_rate) : 0;
+  }
+
+  #ifdef MultiU24X32toH16 // the stepper's multiply, only stepper.cpp has it
+
+    // Speed change of an S-curve ramp when the linear ramp changed by delta out of change:
+    // the smoothstep 3u^2 - 2u^3 of u = delta / change, computed as delta * u * (3 - 2u).
+    // Acceleration is zero at both ends of the ramp and the time and distance are the ones
+    // of the linear ramp, 1.5 times its acceleration in the middle.
+    FORCE_INLINE unsigned short s_curve_delta(unsigned short delta, unsigned short change, unsigned long curve) {
+      if (!curve || delta >= change) return delta;
+      unsigned short u, g;
+      MultiU24X32toH16(u, (unsigned long)delta, curve);                               // u = delta / change, Q16
+      MultiU24X32toH16(g, (unsigned long)u, (3UL << 23) - ((unsigned long)u << 8));  // g = u * (3 - 2u), Q15
+      MultiU24X32toH16(delta, (unsigned long)delta, (unsigned long)g << 9);           // delta * g
+      return delta;
+    }
+
+  #endif
+
+#endif // S_CURVE_H
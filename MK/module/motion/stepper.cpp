@@ -45,14 +45,37 @@ block_t* current_block;  // A pointer to the block currently being traced
 static unsigned char out_bits = 0;        // The next stepping-bits to be output
 static unsigned int cleaning_buffer_counter;
 
+// Step loop variants, see step_loop()
+#define STEP_KERNEL_MOVE    0 // no laser pulses
+#define STEP_KERNEL_PULSED  1 // a pulse every 1/ppm mm
+#define STEP_KERNEL_RASTER  2 // a raster pixel every pulse
+#define STEP_KERNEL_TIMED   4 // the laser goes off after laser_duration
+#define STEP_KERNEL_RAMP    8 // the intensity changes every step event
+
 #ifdef LASER
 static long counter_l;
+static uint8_t step_kernel;
 #endif // LASER
 
+#ifdef LASER_POWER_RAMP
+static long laser_ramp_intensity; // requested intensity, 16.16 fixed point
+static int laser_ramp_fired;      // requested intensity of the last laser_fire_block() of the ramp
+#endif // LASER_POWER_RAMP
+
 #ifdef LASER_RASTER
 static int counter_raster;
 #endif // LASER_RASTER
 
+#if ENABLED(LASER)
+  // Fire at an intensity of the running block, the power override (M649 O) applies at once
+  FORCE_INLINE void laser_fire_block(int intensity) {
+    #if ENABLED(REALTIME_OVERRIDES)
+      intensity = ((long)intensity * laser.power_scale) >> 8;
+    #endif
+    laser_fire(intensity);
+  }
+#endif
+
 
 
 #if ENABLED(Z_DUAL_ENDSTOPS)
@@ -78,6 +101,21 @@ static uint8_t step_loops;
 static uint8_t step_loops_nominal;
 static unsigned short OCR1A_nominal;
 
+#if ENABLED(LASER) || ENABLED(LASERBEAM)
+  static bool planner_drained = true; // the beam follows M3/M4/M5 once the planner is empty
+#endif
+
+#if ENABLED(FEED_HOLD)
+  #define FEED_HOLD_MIN_RATE 120 // steps/s where a hold counts as stopped, the planner's lowest rate
+  enum FeedHoldState { FEED_RUNNING, FEED_HOLD_DECEL, FEED_HELD };
+  static volatile uint8_t feed_hold_state = FEED_RUNNING;
+  static unsigned short step_rate_now;         // the rate of the last step event, where a hold starts from
+  static unsigned short hold_rate;             // the rate when the hold was requested
+  static long hold_time;                       // timer ticks since the hold was requested
+  static unsigned short acc_initial_rate;      // base of the acceleration ramp, the block's initial rate or the resume rate
+  static volatile bool feed_resume_accel = false; // ramp up from rest after a hold, whatever the block's profile says
+#endif
+
 volatile long endstops_trigsteps[3] = { 0 };
 volatile long endstops_stepsTotal, endstops_stepsDone;
 static volatile char endstop_hit_bits = 0; // use X_MIN, Y_MIN, Z_MIN and Z_PROBE as BIT value
@@ -258,6 +296,14 @@ volatile signed char count_direction[NUM_AXIS] = { 1 };
                  "r26" , "r27" \
                )
 
+#if ENABLED(S_CURVE_ACCELERATION)
+
+  static unsigned long acc_curve, dec_curve; // the block's S-curve factors, 0 when the ramp runs linear
+
+  #include "s_curve.h"
+
+#endif
+
 // Some useful constants
 
 #define ENABLE_STEPPER_DRIVER_INTERRUPT()  SBI(TIMSK1, OCIE1A)
@@ -327,7 +373,56 @@ void checkHitEndstops() {
   #define CORE_AXIS_2 C_AXIS
 #endif
 
-void enable_endstops(bool check) { check_endstops = check; }
+#if ENABLED(ENDSTOP_INTERRUPTS_FEATURE)
+
+  // Stepper ISRs that have to read the endstops, 2 to pass the double read check of update_endstops()
+  static volatile uint8_t endstop_poll = 2;
+  static bool endstop_poll_always = false; // an endstop pin can't raise an interrupt
+
+  static void endstop_ISR() { endstop_poll = 2; }
+
+  #ifdef PCINT0_vect
+    ISR(PCINT0_vect) { endstop_ISR(); }
+  #endif
+  #ifdef PCINT1_vect
+    ISR(PCINT1_vect) { endstop_ISR(); }
+  #endif
+  #ifdef PCINT2_vect
+    ISR(PCINT2_vect) { endstop_ISR(); }
+  #endif
+  #ifdef PCINT3_vect
+    ISR(PCINT3_vect) { endstop_ISR(); }
+  #endif
+
+  // Use the external interrupt of the pin, or else its pin change interrupt
+  static void endstop_interrupt_init(const uint8_t pin) {
+    if (digitalPinToInterrupt(pin) != NOT_AN_INTERRUPT) {
+      attachInterrupt(digitalPinToInterrupt(pin), endstop_ISR, CHANGE);
+      return;
+    }
+    volatile uint8_t* pcicr = digitalPinToPCICR(pin);
+    if (pcicr) {
+      *digitalPinToPCMSK(pin) |= _BV(digitalPinToPCMSKbit(pin));
+      *pcicr |= _BV(digitalPinToPCICRbit(pin));
+    }
+    else
+      endstop_poll_always = true;
+  }
+
+  FORCE_INLINE bool endstops_need_update() {
+    if (endstop_poll_always || old_endstop_bits) return true; // a triggered endstop is read until released
+    if (!endstop_poll) return false;
+    endstop_poll--;
+    return true;
+  }
+
+  void enable_endstops(bool check) { check_endstops = check; endstop_poll = 2; }
+
+#else
+
+  void enable_endstops(bool check) { check_endstops = check; }
+
+#endif // ENDSTOP_INTERRUPTS_FEATURE
 
 // Check endstops - Called from ISR!
 inline void update_endstops() {
@@ -634,15 +729,243 @@ FORCE_INLINE void trapezoid_generator_reset() {
   // make a note of the number of step loops required at nominal speed
   step_loops_nominal = step_loops;
   acc_step_rate = current_block->initial_rate;
+  #if ENABLED(FEED_HOLD)
+    #if ENABLED(PLANNER_DWELL)
+      if (current_block->dwell) feed_resume_accel = false; // fixed rate, the move after it starts from rest
+    #endif
+    // A block started while coming back from a hold goes on from the rate the last one reached
+    if (feed_resume_accel) NOMORE(acc_step_rate, step_rate_now);
+    acc_initial_rate = acc_step_rate;
+  #endif
+  #if ENABLED(S_CURVE_ACCELERATION)
+    acc_curve = current_block->accel_curve;
+    dec_curve = current_block->decel_curve;
+    #if ENABLED(FEED_HOLD)
+      if (feed_resume_accel) acc_curve = dec_curve = 0; // the ramps don't match the planned ones
+    #endif
+  #endif
   acceleration_time = calc_timer(acc_step_rate);
   OCR1A = acceleration_time;
 }
 
+#define _COUNTER(axis) counter_## axis
+#define _APPLY_STEP(AXIS) AXIS ##_APPLY_STEP
+#define _INVERT_STEP_PIN(AXIS) INVERT_## AXIS ##_STEP_PIN
+
+#define STEP_START(axis, AXIS) \
+  _COUNTER(axis) += current_block->steps[_AXIS(AXIS)]; \
+  if (_COUNTER(axis) > 0) _APPLY_STEP(AXIS)(!_INVERT_STEP_PIN(AXIS),0);
+
+#define STEP_START_MIXING \
+  for (uint8_t j = 0; j < DRIVER_EXTRUDERS; j++) {  \
+    counter_m[j] += current_block->mix_event_count[j];  \
+    if (counter_m[j] > 0) En_STEP_WRITE(j, !INVERT_E_STEP_PIN); \
+  }
+
+#define STEP_END(axis, AXIS) \
+  if (_COUNTER(axis) > 0) { \
+    _COUNTER(axis) -= current_block->step_event_count; \
+    count_position[_AXIS(AXIS)] += count_direction[_AXIS(AXIS)]; \
+    _APPLY_STEP(AXIS)(_INVERT_STEP_PIN(AXIS),0); \
+  }
+
+#define STEP_END_MIXING \
+  for (uint8_t j = 0; j < DRIVER_EXTRUDERS; j++) {  \
+    if (counter_m[j] > 0) { \
+      counter_m[j] -= current_block->step_event_count;  \
+      En_STEP_WRITE(j, INVERT_E_STEP_PIN);  \
+    } \
+  }
+
+#if ENABLED(STEP_PORT_BATCHING)
+
+  // Port and bit of a step pin, from the DIO table of fastio.h
+  #define __STEP_RPORT(IO) DIO ## IO ## _RPORT
+  #define _STEP_RPORT(IO) __STEP_RPORT(IO)
+  #define __STEP_MASK(IO) MASK(DIO ## IO ## _PIN)
+  #define _STEP_MASK(IO) __STEP_MASK(IO)
+
+  #define STEP_BATCH_PORT _STEP_RPORT(X_STEP_PIN)
+  // Constant folded by the compiler, the axis is pulsed with X when true
+  #define STEP_BATCHED(AXIS) (&_STEP_RPORT(AXIS ##_STEP_PIN) == &STEP_BATCH_PORT)
+
+  // A 1 written to the PIN register toggles the output, so the same mask starts and ends the pulses
+  #define STEP_START_BATCH(axis, AXIS) \
+    _COUNTER(axis) += current_block->steps[_AXIS(AXIS)]; \
+    if (_COUNTER(axis) > 0) { \
+      if (STEP_BATCHED(AXIS)) step_mask |= _STEP_MASK(AXIS ##_STEP_PIN); \
+      else _APPLY_STEP(AXIS)(!_INVERT_STEP_PIN(AXIS),0); \
+    }
+
+  #define STEP_END_BATCH(axis, AXIS) \
+    if (_COUNTER(axis) > 0) { \
+      _COUNTER(axis) -= current_block->step_event_count; \
+      count_position[_AXIS(AXIS)] += count_direction[_AXIS(AXIS)]; \
+      if (!STEP_BATCHED(AXIS)) _APPLY_STEP(AXIS)(_INVERT_STEP_PIN(AXIS),0); \
+    }
+
+#endif // STEP_PORT_BATCHING
+
+/**
+ * Step loop of the ISR, specialized for the laser work of the block.
+ * KERNEL is known at compile time, so every kernel only contains the
+ * checks its blocks need. The kernel is chosen once per block in
+ * set_step_kernel().
+ */
+template<uint8_t KERNEL>
+FORCE_INLINE void step_loop() {
+  for (uint8_t i = 0; i < step_loops; i++) {
+
+    MKSERIAL.checkRx(); // Check for serial chars.
+    #if ENABLED(REALTIME_COMMANDS)
+      if (cleaning_buffer_counter) break; // Ctrl-X came in: no more steps or pulses from this block
+    #endif
+
+    #if ENABLED(ADVANCE)
+      counter_e += current_block->steps[E_AXIS];
+      if (counter_e > 0) {
+        counter_e -= current_block->step_event_count;
+        #if DISABLED(COLOR_MIXING_EXTRUDER)
+          // Don't step E for mixing extruder
+          e_steps[current_block->active_driver] += TEST(out_bits, E_AXIS) ? -1 : 1;
+        #endif
+      }
+
+      #if ENABLED(COLOR_MIXING_EXTRUDER)
+        long dir = TEST(out_bits, E_AXIS) ? -1 : 1;
+        for (uint8_t j = 0; j < DRIVER_EXTRUDERS; j++) {
+          counter_m[j] += current_block->steps[E_AXIS];
+          if (counter_m[j] > 0) {
+            counter_m[j] -= current_block->mix_event_count[j];
+            e_steps[j] += dir;
+          }
+        }
+      #endif // !COLOR_MIXING_EXTRUDER
+    #endif // ADVANCE
+
+    #if ENABLED(STEP_PORT_BATCHING)
+      uint8_t step_mask = 0;
+      STEP_START_BATCH(x, X);
+      STEP_START_BATCH(y, Y);
+      STEP_START_BATCH(z, Z);
+      if (step_mask) STEP_BATCH_PORT = step_mask;
+    #else
+      STEP_START(x, X);
+      STEP_START(y, Y);
+      STEP_START(z, Z);
+    #endif
+    #if DISABLED(ADVANCE)
+      STEP_START(e, E);
+      #if ENABLED(COLOR_MIXING_EXTRUDER)
+        STEP_START_MIXING;
+      #endif
+    #endif
+
+    #if ENABLED(STEPPER_HIGH_LOW) && STEPPER_HIGH_LOW_DELAY > 0
+      HAL::delayMicroseconds(STEPPER_HIGH_LOW_DELAY);
+    #endif
+
+    #if ENABLED(STEP_PORT_BATCHING)
+      STEP_END_BATCH(x, X);
+      STEP_END_BATCH(y, Y);
+      STEP_END_BATCH(z, Z);
+      if (step_mask) STEP_BATCH_PORT = step_mask;
+    #else
+      STEP_END(x, X);
+      STEP_END(y, Y);
+      STEP_END(z, Z);
+    #endif
+    #if DISABLED(ADVANCE)
+      STEP_END(e, E);
+      #if ENABLED(COLOR_MIXING_EXTRUDER)
+        STEP_END_MIXING;
+      #endif
+    #endif
+
+    #if ENABLED(LASER)
+      if (KERNEL & STEP_KERNEL_PULSED) { // Pulsed Firing Mode
+        // counter_l is the pulse phase, carried over from the previous pulsed block
+        counter_l += current_block->laser_pulse_rate;
+        if (counter_l >= 0) {
+          laser_fire_block(current_block->laser_intensity);
+          if (laser.diagnostics) {
+            ECHO_MV("X: ", counter_x);
+            ECHO_MV("Y: ", counter_y);
+            ECHO_MV("L: ", counter_l);
+          }
+          counter_l -= 65536L;
+        }
+      }
+      #if ENABLED(LASER_RASTER)
+        if (KERNEL & STEP_KERNEL_RASTER) { // Raster Firing Mode
+          // Bresenham over the step events: steps_l is the pixel count, so every pixel fires once
+          counter_l += current_block->steps_l;
+          if (counter_l > 0) {
+            // For some reason, when comparing raster power to ppm line burns the rasters were around 2% more powerful
+            // going from darkened paper to burning through paper.
+            laser_fire_block(current_block->laser_raster_data[counter_raster]);
+            if (laser.diagnostics) {
+              ECHO_MV("Pixel: ", (float)current_block->laser_raster_data[counter_raster]);
+            }
+            counter_raster++;
+            counter_l -= current_block->step_event_count;
+          }
+        }
+      #endif // LASER_RASTER
+      #if ENABLED(LASER_POWER_RAMP)
+        if (KERNEL & STEP_KERNEL_RAMP) laser_ramp_intensity += current_block->laser_ramp;
+      #endif
+      if (KERNEL & STEP_KERNEL_TIMED) {
+        if (laser.last_firing + current_block->laser_duration < micros()) {
+          if (laser.diagnostics) ECHO_LM(INFO, "Laser firing duration elapsed, in interrupt fast loop");
+          laser_extinguish();
+        }
+      }
+    #endif // LASER
+
+    step_events_completed++;
+    if (step_events_completed >= current_block->step_event_count) break;
+  }
+}
+
+#if ENABLED(LASER)
+  // Choose the step loop for the laser work of the new current block
+  FORCE_INLINE void set_step_kernel() {
+    step_kernel = STEP_KERNEL_MOVE;
+    if (current_block->laser_status == LASER_ON) {
+      if (current_block->laser_mode == PULSED) step_kernel = STEP_KERNEL_PULSED;
+      #if ENABLED(LASER_RASTER)
+        else if (current_block->laser_mode == RASTER) step_kernel = STEP_KERNEL_RASTER;
+      #endif
+      #if ENABLED(LASER_POWER_RAMP)
+        else if (current_block->laser_ramp) step_kernel = STEP_KERNEL_RAMP;
+        laser_ramp_intensity = (long)current_block->laser_ramp_start << 16;
+        laser_ramp_fired = -1;
+      #endif
+    }
+    if (current_block->laser_duration != 0) step_kernel |= STEP_KERNEL_TIMED;
+  }
+#endif
+
+#if ENABLED(LASER_RASTER_RESUME) || ENABLED(POWER_LOSS_JOURNAL)
+  // Position of the head along axis in steps, undoing the core kinematics like st_get_axis_position_mm()
+  FORCE_INLINE long head_position(const uint8_t axis) {
+    #if MECH(COREXY) || MECH(COREYX) || MECH(COREXZ) || MECH(COREZX)
+      if (axis == X_AXIS || axis == CORE_AXIS_2)
+        return (count_position[A_AXIS] + ((axis == X_AXIS) ? count_position[CORE_AXIS_2] : -count_position[CORE_AXIS_2])) / 2;
+    #endif
+    return count_position[axis];
+  }
+#endif
+
 // "The Stepper Driver Interrupt" - This timer interrupt is the workhorse.
 // It pops blocks from the block_buffer and executes them by pulsing the stepper pins appropriately.
 ISR(TIMER1_COMPA_vect) {
 
   if (cleaning_buffer_counter) {
+    #if ENABLED(LASER)
+      laser_extinguish(); // the dropped blocks must not leave the laser firing
+    #endif
     current_block = NULL;
     plan_discard_current_block();
     #if ENABLED(SD_FINISHED_RELEASECOMMAND)
@@ -660,6 +983,14 @@ ISR(TIMER1_COMPA_vect) {
     }
   #endif
 
+  #if ENABLED(FEED_HOLD)
+    // Held: the axes stand still and the remaining blocks wait in the buffer
+    if (feed_hold_state == FEED_HELD) {
+      OCR1A = 2000; // 1kHz
+      return;
+    }
+  #endif
+
   // If there is no current block, attempt to pop one from the buffer
   if (!current_block) {
     // Anything in the buffer?
@@ -672,8 +1003,23 @@ ISR(TIMER1_COMPA_vect) {
       long new_count = -(current_block->step_event_count >> 1);
       counter_x = counter_y = counter_z = counter_e = new_count;
       #if ENABLED(LASER)
-         counter_l = counter_x;
          laser.dur = current_block->laser_duration;
+         uint8_t previous_kernel = step_kernel;
+         set_step_kernel();
+         // Pulsed blocks in a row keep the pulse phase, so the spacing stays even across block boundaries
+         if (!(step_kernel & STEP_KERNEL_PULSED))
+           counter_l = counter_x;
+         else if (!(previous_kernel & STEP_KERNEL_PULSED))
+           counter_l = -32768L; // first pulse half a pulse spacing in
+      #endif
+
+      // M3/M4/M5 take effect exactly at the start of the block they were planned with
+      #if ENABLED(LASERBEAM)
+        WRITE(LASER_PWR_PIN, current_block->laser_pwr);
+        analogWrite(LASER_TTL_PIN, current_block->laser_ttlmodulation);
+      #endif
+      #if ENABLED(LASER) || ENABLED(LASERBEAM)
+        planner_drained = false;
       #endif
 
       #if ENABLED(COLOR_MIXING_EXTRUDER)
@@ -683,6 +1029,10 @@ ISR(TIMER1_COMPA_vect) {
 
       step_events_completed = 0;
 
+      #if ENABLED(ENDSTOP_INTERRUPTS_FEATURE)
+        endstop_poll = 2; // the new direction may have an endstop that is already triggered
+      #endif
+
       #if ENABLED(Z_LATE_ENABLE)
         if (current_block->steps[Z_AXIS] > 0) {
           enable_z();
@@ -703,6 +1053,25 @@ ISR(TIMER1_COMPA_vect) {
       // #endif
     }
     else {
+      #if ENABLED(LASER) || ENABLED(LASERBEAM)
+        if (!planner_drained) {
+          // Nothing more planned: take the state of the last M3/M4/M5, which may come after the last move
+          #if ENABLED(LASER)
+            laser_extinguish(); // the blocks fire the laser, e.g. a dwell of M4 / G4 / M5
+          #endif
+          #if ENABLED(LASERBEAM)
+            WRITE(LASER_PWR_PIN, laser_pwr);
+            analogWrite(LASER_TTL_PIN, laser_ttl_modulation);
+          #endif
+          planner_drained = true;
+        }
+      #endif
+      #if ENABLED(FEED_HOLD)
+        if (feed_hold_state == FEED_HOLD_DECEL) { // ran out of moves while slowing down
+          feed_hold_state = FEED_HELD;
+          step_rate_now = FEED_HOLD_MIN_RATE;
+        }
+      #endif
       OCR1A = 2000; // 1kHz
     }
   }
@@ -710,12 +1079,29 @@ ISR(TIMER1_COMPA_vect) {
   if (current_block != NULL) {
 
     // Update endstops state, if enabled
-    if (check_endstops) update_endstops();
+    #if ENABLED(ENDSTOP_INTERRUPTS_FEATURE)
+      if (check_endstops && endstops_need_update()) update_endstops();
+    #else
+      if (check_endstops) update_endstops();
+    #endif
 
     // Continuous firing of the laser during a move happens here, PPM and raster happen further down
     #if ENABLED(LASER)
       if (current_block->laser_mode == CONTINUOUS && current_block->laser_status == LASER_ON) {
-         laser_fire(current_block->laser_intensity);
+        #if ENABLED(LASER_POWER_RAMP)
+          if (step_kernel & STEP_KERNEL_RAMP) {
+            int intensity = laser_ramp_intensity >> 16;
+            if (intensity != laser_ramp_fired || laser.firing != LASER_ON) {
+              laser_ramp_fired = intensity;
+              #if ENABLED(LASER_POWER_CALIBRATION)
+                intensity = laser_calibrate(intensity);
+              #endif
+              laser_fire_block(intensity);
+            }
+          }
+          else
+        #endif
+         laser_fire_block(current_block->laser_intensity);
       }
       if (current_block->laser_status == LASER_OFF) {
          if (laser.diagnostics) ECHO_LM(INFO,"Laser status set to off, in interrupt handler");
@@ -724,129 +1110,76 @@ ISR(TIMER1_COMPA_vect) {
     #endif
 
     // Take multiple steps per interrupt (For high speed moves)
-    for (uint8_t i = 0; i < step_loops; i++) {
-
-        MKSERIAL.checkRx(); // Check for serial chars.
-
-      #if ENABLED(ADVANCE)
-        counter_e += current_block->steps[E_AXIS];
-        if (counter_e > 0) {
-          counter_e -= current_block->step_event_count;
-          #if DISABLED(COLOR_MIXING_EXTRUDER)
-            // Don't step E for mixing extruder
-            e_steps[current_block->active_driver] += TEST(out_bits, E_AXIS) ? -1 : 1;
-          #endif
-        }
-
-        #if ENABLED(COLOR_MIXING_EXTRUDER)
-          long dir = TEST(out_bits, E_AXIS) ? -1 : 1;
-          for (uint8_t j = 0; j < DRIVER_EXTRUDERS; j++) {
-            counter_m[j] += current_block->steps[E_AXIS];
-            if (counter_m[j] > 0) {
-              counter_m[j] -= current_block->mix_event_count[j];
-              e_steps[j] += dir;
-            }
-          }
-        #endif // !COLOR_MIXING_EXTRUDER
-      #endif // ADVANCE
-
-      #define _COUNTER(axis) counter_## axis
-      #define _APPLY_STEP(AXIS) AXIS ##_APPLY_STEP
-      #define _INVERT_STEP_PIN(AXIS) INVERT_## AXIS ##_STEP_PIN
-
-      #define STEP_START(axis, AXIS) \
-        _COUNTER(axis) += current_block->steps[_AXIS(AXIS)]; \
-        if (_COUNTER(axis) > 0) _APPLY_STEP(AXIS)(!_INVERT_STEP_PIN(AXIS),0);
-
-      #define STEP_START_MIXING \
-        for (uint8_t j = 0; j < DRIVER_EXTRUDERS; j++) {  \
-          counter_m[j] += current_block->mix_event_count[j];  \
-          if (counter_m[j] > 0) En_STEP_WRITE(j, !INVERT_E_STEP_PIN); \
-        }
-
-      #define STEP_END(axis, AXIS) \
-        if (_COUNTER(axis) > 0) { \
-          _COUNTER(axis) -= current_block->step_event_count; \
-          count_position[_AXIS(AXIS)] += count_direction[_AXIS(AXIS)]; \
-          _APPLY_STEP(AXIS)(_INVERT_STEP_PIN(AXIS),0); \
-        }
-
-      #define STEP_END_MIXING \
-        for (uint8_t j = 0; j < DRIVER_EXTRUDERS; j++) {  \
-          if (counter_m[j] > 0) { \
-            counter_m[j] -= current_block->step_event_count;  \
-            En_STEP_WRITE(j, INVERT_E_STEP_PIN);  \
-          } \
-        }
-
-      STEP_START(x, X);
-      STEP_START(y, Y);
-      STEP_START(z, Z);
-      #if DISABLED(ADVANCE)
-        STEP_START(e, E);
-        #if ENABLED(COLOR_MIXING_EXTRUDER)
-          STEP_START_MIXING;
+    #if ENABLED(LASER)
+      switch (step_kernel) {
+        case STEP_KERNEL_PULSED:                       step_loop<STEP_KERNEL_PULSED>(); break;
+        case STEP_KERNEL_TIMED:                        step_loop<STEP_KERNEL_TIMED>(); break;
+        case STEP_KERNEL_PULSED | STEP_KERNEL_TIMED:   step_loop<STEP_KERNEL_PULSED | STEP_KERNEL_TIMED>(); break;
+        #if ENABLED(LASER_RASTER)
+          case STEP_KERNEL_RASTER:                     step_loop<STEP_KERNEL_RASTER>(); break;
+          case STEP_KERNEL_RASTER | STEP_KERNEL_TIMED: step_loop<STEP_KERNEL_RASTER | STEP_KERNEL_TIMED>(); break;
         #endif
-      #endif
-
-      #if ENABLED(STEPPER_HIGH_LOW) && STEPPER_HIGH_LOW_DELAY > 0
-        HAL::delayMicroseconds(STEPPER_HIGH_LOW_DELAY);
-      #endif
-
-      STEP_END(x, X);
-      STEP_END(y, Y);
-      STEP_END(z, Z);
-      #if DISABLED(ADVANCE)
-        STEP_END(e, E);
-        #if ENABLED(COLOR_MIXING_EXTRUDER)
-          STEP_END_MIXING;
+        #if ENABLED(LASER_POWER_RAMP)
+          case STEP_KERNEL_RAMP:                       step_loop<STEP_KERNEL_RAMP>(); break;
+          case STEP_KERNEL_RAMP | STEP_KERNEL_TIMED:   step_loop<STEP_KERNEL_RAMP | STEP_KERNEL_TIMED>(); break;
         #endif
-      #endif
-
-      #if ENABLED(LASER)
-        counter_l += current_block->steps_l;
-        if (counter_l > 0) {
-          if (current_block->laser_mode == PULSED && current_block->laser_status == LASER_ON) { // Pulsed Firing Mode
-            laser_fire(current_block->laser_intensity);
-            if (laser.diagnostics) {
-              ECHO_MV("X: ", counter_x);
-              ECHO_MV("Y: ", counter_y);
-              ECHO_MV("L: ", counter_l);
-            }
-          }
-          #if ENABLED(LASER_RASTER)
-            if (current_block->laser_mode == RASTER && current_block->laser_status == LASER_ON) { // Raster Firing Mode
-              // For some reason, when comparing raster power to ppm line burns the rasters were around 2% more powerful
-              // going from darkened paper to burning through paper.
-              laser_fire(current_block->laser_raster_data[counter_raster]); 
-              if (laser.diagnostics) {
-                ECHO_MV("Pixel: ", (float)current_block->laser_raster_data[counter_raster]);
-              }
-              counter_raster++;
-            }
-          #endif // LASER_RASTER
-          counter_l -= current_block->step_event_count;
-        }
-        if (current_block->laser_duration != 0 && (laser.last_firing + current_block->laser_duration < micros())) {
-          if (laser.diagnostics) ECHO_LM(INFO, "Laser firing duration elapsed, in interrupt fast loop");
-          laser_extinguish();
-        }
-      #endif // LASER
-
-
-      step_events_completed++;
-      if (step_events_completed >= current_block->step_event_count) break;
-    }
+        default:                                       step_loop<STEP_KERNEL_MOVE>(); break;
+      }
+    #else
+      step_loop<STEP_KERNEL_MOVE>();
+    #endif
     // Calculate new timer value
     unsigned short timer;
     unsigned short step_rate;
-    if (step_events_completed <= (unsigned long)current_block->accelerate_until) {
+    #if ENABLED(FEED_HOLD)
+      bool accelerating = step_events_completed <= (unsigned long)current_block->accelerate_until;
+      if (feed_resume_accel) {
+        // Back up to nominal speed after a hold, unless the block is already slowing down for its exit
+        if (step_events_completed > (unsigned long)current_block->decelerate_after || acc_step_rate >= current_block->nominal_rate)
+          feed_resume_accel = false;
+        else
+          accelerating = true;
+      }
+      if (feed_hold_state == FEED_HOLD_DECEL) {
+        // Slow down from the rate of the hold request at the block's acceleration.
+        // The ramp goes on across block boundaries as a step rate.
+        #if ENABLED(PLANNER_DWELL)
+          if (current_block->dwell) hold_rate = FEED_HOLD_MIN_RATE; // nothing moves, hold at once
+        #endif
+        MultiU24X32toH16(step_rate, hold_time, current_block->acceleration_rate);
+        step_rate = step_rate < hold_rate - FEED_HOLD_MIN_RATE ? hold_rate - step_rate : FEED_HOLD_MIN_RATE;
+        step_rate_now = step_rate;
+        timer = calc_timer(step_rate);
+        OCR1A = timer;
+        hold_time += timer;
+        if (step_rate <= FEED_HOLD_MIN_RATE) {
+          // Stopped on a step event, which is also a pixel boundary for the laser
+          feed_hold_state = FEED_HELD;
+          #if ENABLED(LASER)
+            laser_extinguish();
+          #endif
+        }
+      }
+      else if (accelerating) {
+    #else
+      if (step_events_completed <= (unsigned long)current_block->accelerate_until) {
+    #endif
 
       MultiU24X32toH16(acc_step_rate, acceleration_time, current_block->acceleration_rate);
-      acc_step_rate += current_block->initial_rate;
+      #if ENABLED(S_CURVE_ACCELERATION)
+        acc_step_rate = s_curve_delta(acc_step_rate, current_block->peak_rate - current_block->initial_rate, acc_curve);
+      #endif
+      #if ENABLED(FEED_HOLD)
+        acc_step_rate += acc_initial_rate;
+      #else
+        acc_step_rate += current_block->initial_rate;
+      #endif
 
       // upper limit
       NOMORE(acc_step_rate, current_block->nominal_rate);
+      #if ENABLED(FEED_HOLD)
+        step_rate_now = acc_step_rate;
+      #endif
 
       // step_rate to timer interval
       timer = calc_timer(acc_step_rate);
@@ -873,6 +1206,9 @@ ISR(TIMER1_COMPA_vect) {
     }
     else if (step_events_completed > (unsigned long)current_block->decelerate_after) {
       MultiU24X32toH16(step_rate, deceleration_time, current_block->acceleration_rate);
+      #if ENABLED(S_CURVE_ACCELERATION)
+        step_rate = s_curve_delta(step_rate, current_block->peak_rate - current_block->final_rate, dec_curve);
+      #endif
 
       if (step_rate <= acc_step_rate) {
         step_rate = acc_step_rate - step_rate; // Decelerate from acceleration end point.
@@ -882,6 +1218,9 @@ ISR(TIMER1_COMPA_vect) {
       else {
         step_rate = current_block->final_rate;
       }
+      #if ENABLED(FEED_HOLD)
+        step_rate_now = step_rate;
+      #endif
 
       // step_rate to timer interval
       timer = calc_timer(step_rate);
@@ -909,12 +1248,43 @@ ISR(TIMER1_COMPA_vect) {
       OCR1A = OCR1A_nominal;
       // ensure we're running at the correct step rate, even if we just came off an acceleration
       step_loops = step_loops_nominal;
+      #if ENABLED(FEED_HOLD)
+        step_rate_now = current_block->nominal_rate;
+      #endif
     }
 
     OCR1A = (OCR1A < (TCNT1 + 16)) ? (TCNT1 + 16) : OCR1A;
 
     // If current block is finished, reset pointer
     if (step_events_completed >= current_block->step_event_count) {
+      #if ENABLED(LASER_RASTER_RESUME)
+        if (current_block->laser_mode == RASTER && current_block->sdpos) {
+          raster_resume.sdpos = current_block->sdpos;
+          raster_resume.line++;
+          raster_resume.steps[X_AXIS] = head_position(X_AXIS);
+          raster_resume.steps[Y_AXIS] = head_position(Y_AXIS);
+          #if MECH(COREXY) || MECH(COREYX) || MECH(COREXZ) || MECH(COREZX)
+            raster_resume.raster_direction = !TEST(current_block->direction_bits, X_HEAD);
+          #else
+            raster_resume.raster_direction = !TEST(current_block->direction_bits, X_AXIS);
+          #endif
+        }
+      #endif
+      #if ENABLED(POWER_LOSS_JOURNAL)
+        if (current_block->sdpos
+          #if ENABLED(PLANNER_DWELL)
+            && !current_block->dwell // a dwell has no feed to resume with
+          #endif
+        ) {
+          card.journal_block.sdpos = current_block->sdpos;
+          for (uint8_t i = X_AXIS; i <= Z_AXIS; i++) card.journal_block.steps[i] = head_position(i);
+          card.journal_block.nominal_speed = current_block->nominal_speed;
+          #if ENABLED(LASER)
+            card.journal_block.laser_intensity = current_block->laser_intensity;
+            card.journal_block.laser_mode = current_block->laser_mode;
+          #endif
+        }
+      #endif
       current_block = NULL;
       plan_discard_current_block();
     }
@@ -1161,6 +1531,39 @@ void st_init() {
     #endif
   #endif
 
+  #if ENABLED(ENDSTOP_INTERRUPTS_FEATURE)
+    #if HAS(X_MIN)
+      endstop_interrupt_init(X_MIN_PIN);
+    #endif
+    #if HAS(X_MAX)
+      endstop_interrupt_init(X_MAX_PIN);
+    #endif
+    #if HAS(Y_MIN)
+      endstop_interrupt_init(Y_MIN_PIN);
+    #endif
+    #if HAS(Y_MAX)
+      endstop_interrupt_init(Y_MAX_PIN);
+    #endif
+    #if HAS(Z_MIN)
+      endstop_interrupt_init(Z_MIN_PIN);
+    #endif
+    #if HAS(Z_MAX)
+      endstop_interrupt_init(Z_MAX_PIN);
+    #endif
+    #if HAS(Z2_MIN)
+      endstop_interrupt_init(Z2_MIN_PIN);
+    #endif
+    #if HAS(Z2_MAX)
+      endstop_interrupt_init(Z2_MAX_PIN);
+    #endif
+    #if HAS(Z_PROBE)
+      endstop_interrupt_init(Z_PROBE_PIN);
+    #endif
+    #if HAS(E_MIN)
+      endstop_interrupt_init(E_MIN_PIN);
+    #endif
+  #endif
+
   #define _STEP_INIT(AXIS) AXIS ##_STEP_INIT
   #define _WRITE_STEP(AXIS, HIGHLOW) AXIS ##_STEP_WRITE(HIGHLOW)
   #define _DISABLE(axis) disable_## axis()
@@ -1326,9 +1729,65 @@ void quickStop() {
   DISABLE_STEPPER_DRIVER_INTERRUPT();
   while (blocks_queued()) plan_discard_current_block();
   current_block = NULL;
+  #if ENABLED(FEED_HOLD)
+    feed_hold_state = FEED_RUNNING;
+    feed_resume_accel = false;
+  #endif
   ENABLE_STEPPER_DRIVER_INTERRUPT();
 }
 
+#if ENABLED(REALTIME_COMMANDS)
+  // quickStop() for an interrupt handler: the stepper ISR drops the running and the
+  // planned blocks itself, without firing the laser. Call quickStop() afterwards.
+  void quickStopFromISR() {
+    cleaning_buffer_counter = 5000;
+  }
+#endif
+
+#if ENABLED(FEED_HOLD)
+
+  // Bring the axes to rest at the planned acceleration, keeping the remaining blocks
+  void st_feed_hold() {
+    CRITICAL_SECTION_START;
+    if (feed_hold_state == FEED_RUNNING) {
+      hold_rate = step_rate_now;
+      NOLESS(hold_rate, FEED_HOLD_MIN_RATE);
+      step_rate_now = hold_rate;
+      hold_time = 0;
+      feed_resume_accel = false;
+      feed_hold_state = FEED_HOLD_DECEL;
+    }
+    CRITICAL_SECTION_END;
+  }
+
+  // Continue the held moves, accelerating from where the hold left the axes
+  void st_feed_resume() {
+    CRITICAL_SECTION_START;
+    if (feed_hold_state != FEED_RUNNING) {
+      bool ramp = true;
+      #if ENABLED(PLANNER_DWELL)
+        if (current_block && current_block->dwell) ramp = false; // a held dwell goes on with its fixed rate
+      #endif
+      if (ramp) {
+        if (current_block) {
+          acc_step_rate = acc_initial_rate = step_rate_now;
+          acceleration_time = calc_timer(acc_step_rate);
+          deceleration_time = 0;
+          #if ENABLED(S_CURVE_ACCELERATION)
+            acc_curve = dec_curve = 0;
+          #endif
+        }
+        feed_resume_accel = true;
+      }
+      feed_hold_state = FEED_RUNNING;
+    }
+    CRITICAL_SECTION_END;
+  }
+
+  bool st_feed_held() { return feed_hold_state != FEED_RUNNING; }
+
+#endif // FEED_HOLD
+
 #if ENABLED(NPR2)
   void colorstep(long csteps,const bool direction) {
     enable_e1();
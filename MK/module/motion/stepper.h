@@ -73,6 +73,15 @@
   extern block_t *current_block;  // A pointer to the block currently being traced
 
   void quickStop();
+  #if ENABLED(REALTIME_COMMANDS)
+    void quickStopFromISR();
+  #endif
+
+  #if ENABLED(FEED_HOLD)
+    void st_feed_hold();   // decelerate to rest and keep the remaining moves
+    void st_feed_resume(); // continue the held moves
+    bool st_feed_held();
+  #endif
 
   void digitalPotWrite(int address, int value);
   void microstep_ms(uint8_t driver, int8_t ms1, int8_t ms2);
@@ -393,6 +393,19 @@
     #endif
   #endif
 
+  #if ENABLED(FEED_HOLD) && ENABLED(ADVANCE)
+    #error DEPENDENCY ERROR: FEED_HOLD is not compatible with ADVANCE
+  #endif
+  #if ENABLED(FEED_HOLD) && DISABLED(ULTIPANEL) && DISABLED(REALTIME_COMMANDS)
+    #error DEPENDENCY ERROR: FEED_HOLD requires ULTIPANEL or REALTIME_COMMANDS, a serial M24 can't resume a hold while the planner buffer is full
+  #endif
+
+  #if ENABLED(REALTIME_COMMANDS)
+    #if DISABLED(RT_STATUS_CHAR) || DISABLED(RT_FEED_HOLD_CHAR) || DISABLED(RT_RESUME_CHAR) || DISABLED(RT_LASER_KILL_CHAR)
+      #error DEPENDENCY ERROR: Missing setting RT_STATUS_CHAR, RT_FEED_HOLD_CHAR, RT_RESUME_CHAR or RT_LASER_KILL_CHAR
+    #endif
+  #endif
+
   #if ENABLED(FILAMENTCHANGEENABLE)
     #if DISABLED(FILAMENTCHANGE_XPOS)
       #error DEPENDENCY ERROR: Missing setting FILAMENTCHANGE_XPOS
@@ -717,6 +730,11 @@
       #error DEPENDENCY ERROR: Missing setting STEPPER_HIGH_LOW_DELAY
     #endif
   #endif
+  #if ENABLED(STEP_PORT_BATCHING)
+    #if ENABLED(DUAL_X_CARRIAGE) || ENABLED(Y_DUAL_STEPPER_DRIVERS) || ENABLED(Z_DUAL_STEPPER_DRIVERS) || ENABLED(HAVE_L6470DRIVER)
+      #error CONFLICT ERROR: STEP_PORT_BATCHING is incompatible with dual stepper drivers, DUAL_X_CARRIAGE and L6470 drivers
+    #endif
+  #endif
   #if ENABLED(DIGIPOT_I2C)
     #if DISABLED(DIGIPOT_I2C_NUM_CHANNELS)
       #error DEPENDENCY ERROR: Missing setting DIGIPOT_I2C_NUM_CHANNELS
@@ -1345,6 +1363,33 @@
     #error CONFLICT ERROR: You cannot have dual stepper drivers for both Y and Z.
   #endif
 
+  /**
+   * SD bulk upload
+   */
+  #if ENABLED(SD_BULK_UPLOAD)
+    #if DISABLED(SDSUPPORT)
+      #error DEPENDENCY ERROR: SD_BULK_UPLOAD requires SDSUPPORT.
+    #endif
+    #if SD_BULK_BLOCK_SIZE > 512 || 512 % SD_BULK_BLOCK_SIZE != 0
+      #error CONFLICT ERROR: SD_BULK_BLOCK_SIZE must be a divisor of 512.
+    #endif
+    #if DISABLED(SD_BULK_RX_BUFFER) || (SD_BULK_RX_BUFFER & (SD_BULK_RX_BUFFER - 1)) != 0
+      #error CONFLICT ERROR: SD_BULK_RX_BUFFER must be a power of 2.
+    #endif
+  #endif
+
+  /**
+   * Power loss journal
+   */
+  #if ENABLED(POWER_LOSS_JOURNAL)
+    #if DISABLED(SDSUPPORT)
+      #error DEPENDENCY ERROR: POWER_LOSS_JOURNAL requires SDSUPPORT.
+    #endif
+    #if DISABLED(POWER_LOSS_JOURNAL_INTERVAL) || DISABLED(POWER_LOSS_JOURNAL_SLOTS)
+      #error DEPENDENCY ERROR: Missing setting POWER_LOSS_JOURNAL_INTERVAL or POWER_LOSS_JOURNAL_SLOTS
+    #endif
+  #endif
+
   /**
    * Progress Bar
    */
@@ -1749,6 +1794,26 @@
     #error DEPENDENCY ERROR: You must enable only one of LASERBEAM or LASER, not both!
   #endif
 
+  #if ENABLED(LASER_CURRENT_HISTOGRAM) && (DISABLED(LASER) || DISABLED(POWER_CONSUMPTION))
+    #error DEPENDENCY ERROR: You have to enable LASER and POWER_CONSUMPTION to use LASER_CURRENT_HISTOGRAM
+  #endif
+
+  #if ENABLED(LASER_RASTER_RESUME) && (DISABLED(LASER_RASTER) || DISABLED(SDSUPPORT))
+    #error DEPENDENCY ERROR: You have to enable LASER_RASTER and SDSUPPORT to use LASER_RASTER_RESUME
+  #endif
+
+  #if ENABLED(LASER_POWER_RAMP) && (DISABLED(LASER) || DISABLED(LASER_FIRE_G1))
+    #error DEPENDENCY ERROR: You have to enable LASER and LASER_FIRE_G1 to use LASER_POWER_RAMP
+  #endif
+
+  #if ENABLED(LASER_POWER_CALIBRATION) && DISABLED(LASER)
+    #error DEPENDENCY ERROR: You have to enable LASER to use LASER_POWER_CALIBRATION
+  #endif
+
+  #if ENABLED(LASER_POWER_CALIBRATION) && (LASER_CAL_POINTS < 2 || LASER_CAL_POINTS > 101)
+    #error DEPENDENCY ERROR: LASER_CAL_POINTS must be between 2 and 101
+  #endif
+
   #if ENABLED(FILAMENT_RUNOUT_SENSOR) && !PIN_EXISTS(FILRUNOUT)
     #error DEPENDENCY ERROR: You have to set FILRUNOUT_PIN to a valid pin if you enable FILAMENT_RUNOUT_SENSOR
   #endif
@@ -4,6 +4,10 @@
 
 #include "cardreader.h"
 
+#if ENABLED(POWER_LOSS_JOURNAL)
+  #include <avr/eeprom.h>
+#endif
+
 char tempLongFilename[LONG_FILENAME_LENGTH + 1];
 char fullName[LONG_FILENAME_LENGTH * SD_MAX_FOLDER_DEPTH + SD_MAX_FOLDER_DEPTH + 1];
 
@@ -17,6 +21,12 @@ CardReader::CardReader() {
   workDirDepth = 0;
   memset(workDirParents, 0, sizeof(workDirParents));
 
+  #if ENABLED(POWER_LOSS_JOURNAL)
+    journal_byte = sizeof(journal);
+    journal_slot = 0;
+    journal.seq = 0;
+  #endif
+
   autostart_stilltocheck = true; //the SD start is delayed, because otherwise the serial cannot answer fast enough to make contact with the host software.
 
   //power to SD reader
@@ -121,11 +131,21 @@ void CardReader::unmount() {
 }
 
 void CardReader::startPrint() {
-  if (cardOK) sdprinting = true;
+  if (cardOK) {
+    sdprinting = true;
+    #if ENABLED(FEED_HOLD)
+      st_feed_resume();
+    #endif
+  }
 }
 
 void CardReader::pausePrint() {
-  if (sdprinting) sdprinting = false;
+  if (sdprinting) {
+    sdprinting = false;
+    #if ENABLED(FEED_HOLD)
+      st_feed_hold();
+    #endif
+  }
 }
 
 void CardReader::continuePrint(bool intern) {}
@@ -230,6 +250,104 @@ void CardReader::finishWrite() {
     ECHO_EM(SERIAL_SD_FILE_SAVED);
 }
 
+#if ENABLED(SD_BULK_UPLOAD)
+
+  #include "sd_bulk_frame.h"
+
+  #define SD_BULK_QUIET   20  // ms of silence that ends a discarded frame
+
+  // All the frames in flight must fit the serial RX buffer while a sector is written
+  #if defined(RX_BUFFER_SIZE) && SD_BULK_WINDOW * SD_BULK_FRAME(SD_BULK_BLOCK_SIZE) > RX_BUFFER_SIZE
+    #error CONFLICT ERROR: SD_BULK_WINDOW * (SD_BULK_BLOCK_SIZE + 6) must not exceed RX_BUFFER_SIZE.
+  #elif defined(SERIAL_RX_BUFFER_SIZE) && SD_BULK_WINDOW * SD_BULK_FRAME(SD_BULK_BLOCK_SIZE) > SERIAL_RX_BUFFER_SIZE
+    #error CONFLICT ERROR: SD_BULK_WINDOW * (SD_BULK_BLOCK_SIZE + 6) must not exceed SERIAL_RX_BUFFER_SIZE.
+  #endif
+
+  static uint8_t bulk_sector[512];
+
+  /**
+   * Wait for a byte from the host keeping the heaters managed.
+   * Returns -1 after timeout_ms without data.
+   */
+  static int bulk_read(uint16_t timeout_ms) {
+    millis_t start = millis();
+    while (MKSERIAL.available() <= 0) {
+      if (millis() - start >= timeout_ms) return -1;
+      manage_heater();
+    }
+    return MKSERIAL.read();
+  }
+
+  /**
+   * Throw away the rest of a broken frame and ask the host
+   * to resend starting from the expected sequence number.
+   */
+  static void bulk_resend(uint8_t seq) {
+    while (bulk_read(SD_BULK_QUIET) >= 0) { /* drain */ }
+    ECHO_LMV(RESEND, "B", (int)seq);
+  }
+
+  /**
+   * Receive a file in binary blocks after "M28 B1 filename".
+   *
+   * The frames are read by sd_bulk_frame.h. len must be a divisor of 512
+   * (except the last data block) and a zero length frame ends the upload.
+   *
+   * Every good frame is answered with "ok B<seq>", a bad one with
+   * "Resend: B<expected seq>". The host may keep several frames in flight
+   * and must go back to the requested one on a resend. Data is written
+   * to the card only in whole 512 bytes sectors.
+   */
+  void CardReader::bulkWrite() {
+    uint8_t expected = 0;
+    uint16_t fill = 0;
+
+    file.writeError = false;
+
+    for (;;) {
+      // Receive straight into the sector buffer, only committed if the frame is good
+      bulk_frame_t frame;
+      bulk_frame_start(frame, bulk_sector + fill, min(SD_BULK_BLOCK_SIZE, sizeof(bulk_sector) - fill));
+      BulkFrameResult result = BULK_MORE;
+      while (result == BULK_MORE) {
+        int c = bulk_read(frame.state == BULK_SYNC ? SD_BULK_TIMEOUT : SD_BULK_QUIET);
+        if (c < 0) break;
+        result = bulk_frame_add(frame, c);
+      }
+      if (result == BULK_MORE && frame.state == BULK_SYNC) break; // host gone, abort
+      if (result != BULK_GOOD) { bulk_resend(expected); continue; }
+
+      uint8_t seq = frame.seq;
+      uint16_t len = frame.len;
+
+      if (seq != expected) {
+        // Duplicate of an already stored frame: confirm it again, else ask for the missing one
+        if ((uint8_t)(expected - seq) <= SD_BULK_WINDOW) ECHO_LMV(OK, "B", (int)seq);
+        else bulk_resend(expected);
+        continue;
+      }
+
+      fill += len;
+      if (fill == sizeof(bulk_sector) || (len == 0 && fill)) {
+        if (file.write(bulk_sector, fill) != (int16_t)fill) file.writeError = true;
+        fill = 0;
+      }
+      expected++;
+
+      ECHO_LMV(OK, "B", (int)seq);
+
+      if (file.writeError) {
+        ECHO_LM(ER, SERIAL_SD_ERR_WRITE_TO_FILE);
+        break;
+      }
+      if (len == 0) break;
+    }
+
+    finishWrite();
+  }
+
+#endif // SD_BULK_UPLOAD
+
 void CardReader::makeDirectory(char *filename) {
   if(!cardOK) return;
   sdprinting = false;
@@ -318,6 +436,12 @@ void CardReader::printingHasFinished() {
   st_synchronize();
   file.close();
   sdprinting = false;
+  #if ENABLED(LASER_RASTER_RESUME)
+    raster_resume_clear();
+  #endif
+  #if ENABLED(POWER_LOSS_JOURNAL)
+    journalClear();
+  #endif
   if (SD_FINISHED_STEPPERRELEASE) {
     //finishAndDisableSteppers();
     enqueuecommands_P(PSTR(SD_FINISHED_RELEASECOMMAND));
@@ -676,4 +800,111 @@ void CardReader::unparseKeyLine(const char* key, char* value) {
   }
 }
 
+#if ENABLED(POWER_LOSS_JOURNAL)
+
+  // The ring sits just below the last 128 bytes of the EEPROM, kept for the raster resume record
+  #define JOURNAL_EEPROM(slot) ((uint8_t*)(E2END + 1 - 128 - (POWER_LOSS_JOURNAL_SLOTS - (slot)) * sizeof(journal_t)))
+
+  static uint8_t journal_checksum(const journal_t &record) {
+    const uint8_t *p = (const uint8_t*)&record;
+    uint8_t sum = 0x5A; // an erased or zeroed slot never checks out
+    for (uint8_t i = 0; i < offsetof(journal_t, checksum); i++) sum += p[i];
+    return sum;
+  }
+
+  /**
+   * Start journaling the selected file. A new job invalidates the old records
+   * first, a resumed job goes on from the newest one.
+   */
+  void CardReader::journalStart(bool resume/*=false*/) {
+    journal_byte = sizeof(journal);
+    if (!journalLoad(journal) || !resume) {
+      journalClear();
+      file.getFilename(journal.filename);
+      journal.filesize = fileSize;
+      journal.sdpos = 0;
+    }
+    CRITICAL_SECTION_START;
+    journal_block.sdpos = 0;
+    CRITICAL_SECTION_END;
+    journal_next_ms = millis() + POWER_LOSS_JOURNAL_INTERVAL;
+  }
+
+  /**
+   * Called from idle(). Every POWER_LOSS_JOURNAL_INTERVAL the last completed move
+   * becomes a new record in the next slot of the ring. The record is written one
+   * byte per call and only when the EEPROM is ready, so nothing ever waits on it.
+   * The checksum is the last byte, a record cut short by a power loss is ignored
+   * and the previous slot is used instead.
+   */
+  void CardReader::journalTick() {
+    if (journal_byte < sizeof(journal)) {
+      if (!eeprom_is_ready()) return;
+      uint8_t *addr = JOURNAL_EEPROM(journal_slot) + journal_byte;
+      uint8_t value = ((uint8_t*)&journal)[journal_byte++];
+      if (eeprom_read_byte(addr) != value) eeprom_write_byte(addr, value);
+      return;
+    }
+
+    millis_t ms = millis();
+    if (!sdprinting || ms < journal_next_ms) return;
+    journal_next_ms = ms + POWER_LOSS_JOURNAL_INTERVAL;
+
+    journal_block_t block;
+    CRITICAL_SECTION_START;
+    block = journal_block;
+    CRITICAL_SECTION_END;
+    if (!block.sdpos || block.sdpos == journal.sdpos) return; // no move completed since the last record
+
+    journal.sdpos = block.sdpos;
+    for (uint8_t i = X_AXIS; i <= Z_AXIS; i++) journal.position[i] = block.steps[i] / axis_steps_per_unit[i];
+    journal.feedrate = block.nominal_speed * 60 * 100 / feedrate_multiplier;
+    #if ENABLED(LASER)
+      #if ENABLED(LASER_POWER_CALIBRATION)
+        journal.laser_intensity = laser_uncalibrate(block.laser_intensity);
+      #else
+        journal.laser_intensity = block.laser_intensity;
+      #endif
+      journal.laser_mode = block.laser_mode;
+      // The blocks of a G1 cut are all on, only the modal spindle state carries over to the next command
+      #if ENABLED(LASER_FIRE_SPINDLE)
+        journal.laser_spindle = laser.fired == LASER_FIRE_SPINDLE && laser.status == LASER_ON;
+      #else
+        journal.laser_spindle = false;
+      #endif
+    #endif
+    journal.seq++;
+    journal.checksum = journal_checksum(journal);
+    journal_slot = journal.seq % POWER_LOSS_JOURNAL_SLOTS;
+    journal_byte = 0;
+  }
+
+  // Invalidate all records, the job finished or another one starts
+  void CardReader::journalClear() {
+    journal_byte = sizeof(journal);
+    journal_t record;
+    for (uint8_t slot = 0; slot < POWER_LOSS_JOURNAL_SLOTS; slot++) {
+      eeprom_read_block(&record, JOURNAL_EEPROM(slot), sizeof(record));
+      if (record.checksum == journal_checksum(record))
+        eeprom_update_byte(JOURNAL_EEPROM(slot) + offsetof(journal_t, checksum), ~record.checksum);
+    }
+  }
+
+  // Newest valid record, false if there is none
+  bool CardReader::journalLoad(journal_t &record) {
+    journal_t slot_record;
+    bool found = false;
+    for (uint8_t slot = 0; slot < POWER_LOSS_JOURNAL_SLOTS; slot++) {
+      eeprom_read_block(&slot_record, JOURNAL_EEPROM(slot), sizeof(slot_record));
+      if (slot_record.checksum != journal_checksum(slot_record)) continue;
+      if (!found || (int16_t)(slot_record.seq - record.seq) > 0) {
+        record = slot_record;
+        found = true;
+      }
+    }
+    return found;
+  }
+
+#endif // POWER_LOSS_JOURNAL
+
 #endif //SDSUPPORT
@@ -18,6 +18,35 @@ enum LsAction { LS_Count, LS_GetFilename };
 
 #include "SDFat.h"
 
+#if ENABLED(POWER_LOSS_JOURNAL)
+  // Checkpoint of an SD job, see CardReader::journalTick()
+  typedef struct {
+    uint16_t seq;                     // the valid record with the newest sequence wins
+    char filename[FILENAME_LENGTH];
+    uint32_t filesize;
+    uint32_t sdpos;                   // file position after the command of the last completed move
+    float position[Z_AXIS + 1];       // XYZ at the end of that move
+    float feedrate;                   // mm/min
+    #if ENABLED(LASER)
+      int laser_intensity;
+      uint8_t laser_mode;
+      bool laser_spindle;             // M3/M4 on, G1 turns the beam on by itself
+    #endif
+    uint8_t checksum;
+  } journal_t;
+
+  // Last completed block that ended an SD command, filled in by the stepper ISR
+  typedef struct {
+    uint32_t sdpos;
+    long steps[Z_AXIS + 1];           // XYZ of the head, not of the core motors
+    float nominal_speed;
+    #if ENABLED(LASER)
+      int laser_intensity;
+      uint8_t laser_mode;
+    #endif
+  } journal_block_t;
+#endif
+
 class CardReader {
 public:
   SdFat fat;
@@ -39,6 +68,16 @@ public:
   void startWrite(char* filename, bool lcd_status = true);
   void deleteFile(char* filename);
   void finishWrite();
+  #if ENABLED(SD_BULK_UPLOAD)
+    void bulkWrite();
+  #endif
+  #if ENABLED(POWER_LOSS_JOURNAL)
+    void journalStart(bool resume = false);
+    void journalTick();
+    void journalClear();
+    bool journalLoad(journal_t &record);
+    journal_block_t journal_block;
+  #endif
   void makeDirectory(char* filename);
   void closeFile(bool store_location = false);
   char *createFilename(char *buffer, const dir_t &p);
@@ -86,6 +125,12 @@ private:
   bool findLayerHeight(char* buf, float& layerHeight);
   bool findFilamentNeed(char* buf, float& filament);
   bool findTotalHeight(char* buf, float& objectHeight);
+  #if ENABLED(POWER_LOSS_JOURNAL)
+    journal_t journal;          // record being written
+    uint8_t journal_byte;       // next byte of it to write, sizeof(journal) when idle
+    uint8_t journal_slot;
+    millis_t journal_next_ms;
+  #endif
 };
 
 extern CardReader card;
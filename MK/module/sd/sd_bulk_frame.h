@@ -0,0 +1,62 @@
+/**
+ * Receiver of the binary frames of "M28 B1 filename" (SD_BULK_UPLOAD),
+ * fed one byte at a time by CardReader::bulkWrite(). No Arduino core
+ * needed, the host tests in test/ check it against scripts/sd_bulk_upload.py.
+ *
+ * Frame: 0xA5, seq, len (LE 16bit), len data bytes, CRC16-XMODEM (BE)
+ * The CRC covers seq, len and data.
+ */
+#ifndef SD_BULK_FRAME_H
+  #define SD_BULK_FRAME_H
+
+  #include <stdint.h>
+  #include <util/crc16.h>
+
+  #define SD_BULK_SYNC  0xA5
+  #define SD_BULK_FRAME(len) ((len) + 6)  // sync, seq, len and CRC around the data
+
+  enum BulkFrameState { BULK_SYNC, BULK_SEQ, BULK_LEN_L, BULK_LEN_H, BULK_DATA, BULK_CRC_H, BULK_CRC_L };
+  enum BulkFrameResult { BULK_MORE, BULK_GOOD, BULK_BAD };
+
+  typedef struct {
+    uint8_t state;    // BulkFrameState
+    uint8_t seq;
+    uint16_t len, count, crc;
+    uint8_t* data;    // where the data bytes go, only valid after BULK_GOOD
+    uint16_t max_len;
+  } bulk_frame_t;
+
+  // Wait for the next frame, its data goes to data if it is at most max_len bytes long
+  static void bulk_frame_start(bulk_frame_t &frame, uint8_t* data, uint16_t max_len) {
+    frame.state = BULK_SYNC;
+    frame.data = data;
+    frame.max_len = max_len;
+  }
+
+  // Add a byte, bytes before the sync marker are skipped
+  static BulkFrameResult bulk_frame_add(bulk_frame_t &frame, uint8_t c) {
+    if (frame.state == BULK_SYNC) {
+      if (c == SD_BULK_SYNC) { frame.state = BULK_SEQ; frame.crc = 0; }
+      return BULK_MORE;
+    }
+    frame.crc = _crc_xmodem_update(frame.crc, c);
+    switch (frame.state) {
+      case BULK_SEQ:   frame.seq = c; frame.state = BULK_LEN_L; break;
+      case BULK_LEN_L: frame.len = c; frame.state = BULK_LEN_H; break;
+      case BULK_LEN_H:
+        frame.len |= c << 8;
+        if (frame.len > frame.max_len) return BULK_BAD;
+        frame.count = 0;
+        frame.state = frame.len ? BULK_DATA : BULK_CRC_H;
+        break;
+      case BULK_DATA:
+        frame.data[frame.count++] = c;
+        if (frame.count == frame.len) frame.state = BULK_CRC_H;
+        break;
+      case BULK_CRC_H: frame.state = BULK_CRC_L; break;
+      case BULK_CRC_L: return frame.crc ? BULK_BAD : BULK_GOOD; // the CRC over its own bytes ends at 0
+    }
+    return BULK_MORE;
+  }
+
+#endif // SD_BULK_FRAME_H
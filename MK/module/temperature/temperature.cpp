@@ -1769,6 +1769,9 @@ ISR(TIMER0_COMPB_vect) {
     case Measure_POWCONSUMPTION:
       #if HAS(POWER_CONSUMPTION_SENSOR)
         raw_powconsumption_value += ADC;
+        #if ENABLED(LASER_CURRENT_HISTOGRAM)
+          laser_current_sample(ADC);
+        #endif
       #endif
       temp_state = PrepareTemp_0;
       temp_count++;
@@ -0,0 +1,111 @@
+#!/usr/bin/python3
+
+# Upload a file to the SD card with the binary M28 mode (SD_BULK_UPLOAD).
+#
+# usage: sd_bulk_upload.py <port> <baudrate> <local file> [remote name]
+#
+# The file is sent in CRC16 protected blocks. Up to WINDOW blocks are kept in
+# flight, the firmware answers "ok B<seq>" for every stored block and
+# "Resend: B<seq>" when a block has to be sent again from <seq> onward.
+# BLOCK_SIZE and WINDOW must not exceed SD_BULK_BLOCK_SIZE and SD_BULK_WINDOW.
+
+import os
+import sys
+import time
+
+import serial
+
+BLOCK_SIZE = 256
+WINDOW = 3
+SYNC = 0xA5
+
+
+def crc16_xmodem(data, crc=0):
+    for b in data:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else crc << 1
+            crc &= 0xFFFF
+    return crc
+
+
+def frame(seq, data):
+    head = bytes([seq & 0xFF, len(data) & 0xFF, len(data) >> 8])
+    crc = crc16_xmodem(head + data)
+    return bytes([SYNC]) + head + data + bytes([crc >> 8, crc & 0xFF])
+
+
+def wait_line(ser, prefix, timeout=10):
+    end = time.time() + timeout
+    while time.time() < end:
+        line = ser.readline().decode('ascii', 'replace').strip()
+        if line:
+            print(line)
+        if line.startswith(prefix):
+            return line
+    raise RuntimeError('timeout waiting for ' + prefix)
+
+
+def upload(ser, data, name):
+    ser.write(('M28 B1 %s\n' % name).encode('ascii'))
+    wait_line(ser, 'Writing to file')
+
+    blocks = [data[i:i + BLOCK_SIZE] for i in range(0, len(data), BLOCK_SIZE)]
+    blocks.append(b'')  # zero length block closes the file
+
+    base = 0      # oldest unacknowledged block
+    sent = 0      # next block to send
+    start = time.time()
+
+    while base < len(blocks):
+        while sent < len(blocks) and sent - base < WINDOW:
+            ser.write(frame(sent, blocks[sent]))
+            sent += 1
+
+        line = ser.readline().decode('ascii', 'replace').strip()
+        if not line:
+            # No answer: start again from the oldest block
+            sent = base
+            continue
+
+        if line.startswith('ok B'):
+            seq = int(line[4:])
+            # Sequence numbers are 8 bit, map back to the block index
+            idx = base + ((seq - base) & 0xFF)
+            if base <= idx < sent:
+                base = idx + 1
+        elif line.startswith('Resend: B'):
+            seq = int(line[9:])
+            sent = base + ((seq - base) & 0xFF)
+            base = sent
+        else:
+            print(line)
+
+        done = min(base, len(blocks) - 1) * BLOCK_SIZE
+        sys.stdout.write('\r%d/%d bytes' % (min(done, len(data)), len(data)))
+        sys.stdout.flush()
+
+    elapsed = time.time() - start
+    print('\n%d bytes in %.1f s (%.0f bytes/s)' % (len(data), elapsed, len(data) / max(elapsed, 0.001)))
+
+
+def main():
+    if len(sys.argv) < 4:
+        print('usage: %s <port> <baudrate> <local file> [remote name]' % sys.argv[0])
+        sys.exit(1)
+
+    port, baud, path = sys.argv[1], int(sys.argv[2]), sys.argv[3]
+    name = sys.argv[4] if len(sys.argv) > 4 else os.path.basename(path)
+
+    with open(path, 'rb') as f:
+        data = f.read()
+
+    ser = serial.Serial(port, baud, timeout=2)
+    time.sleep(2)  # board reset on open
+    ser.reset_input_buffer()
+    upload(ser, data, name)
+    ser.close()
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,59 @@
+/**
+ * base64_decode() of module/base64 against a plain reference encoder
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "test.h"
+#include "base64/Base64.h"
+
+static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+// RFC 4648 with padding
+static int encode(char* out, const uint8_t* in, int len) {
+  int n = 0;
+  for (int i = 0; i < len; i += 3) {
+    unsigned long v = (unsigned long)in[i] << 16;
+    if (i + 1 < len) v |= in[i + 1] << 8;
+    if (i + 2 < len) v |= in[i + 2];
+    out[n++] = alphabet[(v >> 18) & 63];
+    out[n++] = alphabet[(v >> 12) & 63];
+    out[n++] = i + 1 < len ? alphabet[(v >> 6) & 63] : '=';
+    out[n++] = i + 2 < len ? alphabet[v & 63] : '=';
+  }
+  out[n] = 0;
+  return n;
+}
+
+int main() {
+  uint8_t in[300], out[300];
+  char text[410];
+
+  // Every length, padded and unpadded, decodes back to the input
+  srand(1);
+  for (int len = 0; len <= 255; len++) {
+    for (int i = 0; i < len; i++) in[i] = rand() & 0xFF;
+    int n = encode(text, in, len);
+    memset(out, 0, sizeof(out));
+    CHECK_EQ(base64_decode(out, text, n), len);
+    CHECK(memcmp(in, out, len) == 0);
+
+    while (n && text[n - 1] == '=') text[--n] = 0;
+    memset(out, 0, sizeof(out));
+    CHECK_EQ(base64_decode(out, text, n), len);
+    CHECK(memcmp(in, out, len) == 0);
+  }
+
+  // All byte values, the way laser_raster_decode() calls it: 4 digits at a time
+  for (int i = 0; i < 255; i++) in[i] = i;
+  int n = encode(text, in, 255), count = 0;
+  for (int i = 0; i < n; i += 4) count += base64_decode(out + count, text + i, n - i < 4 ? n - i : 4);
+  CHECK_EQ(count, 255);
+  CHECK(memcmp(in, out, 255) == 0);
+
+  // Decoding stops at an invalid digit
+  CHECK_EQ(base64_decode(out, (char*)"QUJD*UJD", 8), 3);
+  CHECK_EQ(base64_decode(out, (char*)"", 0), 0);
+  CHECK_EQ(base64_decode(out, (char*)"Q", 1), 0);
+
+  return test_result("base64");
+}
@@ -0,0 +1,23 @@
+#!/usr/bin/python3
+
+# Write a test payload and the frames scripts/sd_bulk_upload.py sends for it,
+# for sd_bulk_test.cpp.
+#
+# usage: bulk_frames.py <payload file> <frames file>
+
+import os
+import sys
+import types
+
+sys.modules['serial'] = types.ModuleType('serial')  # the port isn't used here
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), '..', 'MK', 'scripts'))
+import sd_bulk_upload as up
+
+data = bytes((i * 131 + (i >> 7)) & 0xFF for i in range(3 * 512 + 77))
+blocks = [data[i:i + up.BLOCK_SIZE] for i in range(0, len(data), up.BLOCK_SIZE)] + [b'']
+
+with open(sys.argv[1], 'wb') as f:
+    f.write(data)
+with open(sys.argv[2], 'wb') as f:
+    for seq, block in enumerate(blocks):
+        f.write(up.frame(seq, block))
@@ -0,0 +1,80 @@
+/**
+ * Laser power calibration of laser/laser_cal.h: fit a curve from a measured
+ * response, map requested intensities through it and back
+ */
+#include <stdlib.h>
+#include "test.h"
+
+#define LASER_CAL_POINTS 11
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+#include "laser/laser_cal.h"
+
+#define STEP (10000 / (LASER_CAL_POINTS - 1))
+
+// Response of the measured samples, linear between them like the fit assumes
+static float response_at(const float response[], float output) {
+  int i = output / STEP;
+  if (i >= LASER_CAL_POINTS - 1) return response[LASER_CAL_POINTS - 1];
+  return response[i] + (response[i + 1] - response[i]) * (output - i * STEP) / STEP;
+}
+
+static void check_monotone() {
+  for (int i = 1; i < LASER_CAL_POINTS; i++) CHECK(laser_cal_curve[i] >= laser_cal_curve[i - 1]);
+  int last = 0;
+  for (int r = 0; r <= 10000; r++) {
+    int out = laser_calibrate(r);
+    CHECK(out >= last);
+    last = out;
+  }
+}
+
+// The fitted curve gets every requested fraction of the full power response
+static void check_fit(const float measured[], float tolerance) {
+  float response[LASER_CAL_POINTS], monotone[LASER_CAL_POINTS];
+  for (int i = 0; i < LASER_CAL_POINTS; i++) response[i] = measured[i];
+  CHECK(laser_cal_fit(response));
+
+  for (int i = 0; i < LASER_CAL_POINTS; i++) monotone[i] = i ? (measured[i] > monotone[i - 1] ? measured[i] : monotone[i - 1]) : measured[0];
+  float full = monotone[LASER_CAL_POINTS - 1];
+  for (int j = 1; j < LASER_CAL_POINTS; j++) {
+    float got = response_at(monotone, laser_cal_curve[j]);
+    CHECK(fabs(got - full * j / (LASER_CAL_POINTS - 1)) <= tolerance * full);
+  }
+  check_monotone();
+}
+
+int main() {
+  float response[LASER_CAL_POINTS];
+
+  // The default curve changes nothing
+  laser_cal_reset();
+  for (int r = 0; r <= 10000; r++) {
+    CHECK_EQ(laser_calibrate(r), r);
+    CHECK_EQ(laser_uncalibrate(r), r);
+  }
+  CHECK_EQ(laser_calibrate(-5), 0);
+  CHECK_EQ(laser_calibrate(12000), 10000);
+
+  // A tube whose power grows with the square of the output
+  for (int i = 0; i < LASER_CAL_POINTS; i++) response[i] = (float)i * i;
+  check_fit(response, 0.001);
+  CHECK(laser_cal_curve[5] > 5000); // half power needs more than half the output
+  for (int r = 0; r <= 10000; r += 7) CHECK(abs(laser_uncalibrate(laser_calibrate(r)) - r) <= 2);
+
+  // Nothing below 30% output, then linear
+  for (int i = 0; i < LASER_CAL_POINTS; i++) response[i] = i < 3 ? 0 : i - 3;
+  check_fit(response, 0.001);
+  CHECK(laser_cal_curve[1] >= 3000);
+
+  // Noisy, not monotone measurements still give a monotone curve
+  const float noisy[LASER_CAL_POINTS] = { 0.1, 0.5, 0.4, 1.2, 1.1, 2.0, 2.6, 2.5, 3.3, 3.9, 4.0 };
+  check_fit(noisy, 0.001);
+
+  // No response at all keeps the curve
+  laser_cal_reset();
+  for (int i = 0; i < LASER_CAL_POINTS; i++) response[i] = 1.0;
+  CHECK(!laser_cal_fit(response));
+  for (int i = 0; i < LASER_CAL_POINTS; i++) CHECK_EQ(laser_cal_curve[i], i * STEP);
+
+  return test_result("laser_cal");
+}
@@ -0,0 +1,52 @@
+/**
+ * S-curve fixed point math of motion/s_curve.h against the smoothstep in floating point
+ */
+#include <stdint.h>
+#include <math.h>
+#include "test.h"
+
+#define FORCE_INLINE inline
+
+// C version of the stepper's AVR multiply: bits 24-39 of the 24 x 32 bit product, rounded
+#define MultiU24X32toH16(intRes, longIn1, longIn2) \
+  intRes = (unsigned short)((((uint64_t)((longIn1) & 0xFFFFFF) * (uint32_t)(longIn2)) + (1UL << 23)) >> 24)
+
+#include "motion/s_curve.h"
+
+int main() {
+  // Short ramps stay linear
+  CHECK_EQ(s_curve_factor(1000, 900), 0);
+  CHECK_EQ(s_curve_factor(1000, 744), 0);
+  CHECK(s_curve_factor(1000, 743) != 0);
+  CHECK_EQ(s_curve_delta(50, 100, 0), 50);
+
+  const unsigned short changes[] = { 257, 300, 1000, 4567, 10000, 20000, 40000, 65000 };
+  for (unsigned c = 0; c < sizeof(changes) / sizeof(changes[0]); c++) {
+    const unsigned short change = changes[c];
+    const unsigned long curve = s_curve_factor(10000UL + change, 10000UL);
+    CHECK(curve != 0);
+    CHECK(curve <= 0xFFFFFFFFUL); // fits the 32 bit unsigned long of the AVR
+
+    double max_error = 0, sum_linear = 0, sum_curve = 0;
+    unsigned short last = 0;
+    for (unsigned long delta = 0; delta <= change; delta++) {
+      const unsigned short got = s_curve_delta(delta, change, curve);
+      const double u = (double)delta / change,
+                   expected = change * u * u * (3 - 2 * u);
+      max_error = fmax(max_error, fabs(got - expected));
+      CHECK(got + 1 >= last); // rounding may take back 1 step/s where the curve is flat, never more
+      CHECK(got <= change);
+      last = got;
+      sum_linear += delta;
+      sum_curve += got;
+    }
+    CHECK_EQ(s_curve_delta(0, change, curve), 0);
+    CHECK_EQ(s_curve_delta(change, change, curve), change);
+    // Within a few steps/s of the smoothstep, and the ramp covers the distance of the linear one
+    CHECK(max_error <= 3);
+    CHECK(fabs(sum_curve - sum_linear) <= 0.001 * sum_linear + change);
+    printf("  change %5u: max error %.2f steps/s\n", change, max_error);
+  }
+
+  return test_result("s_curve");
+}
@@ -0,0 +1,83 @@
+/**
+ * Frame receiver of sd/sd_bulk_frame.h against the frames of scripts/sd_bulk_upload.py
+ *
+ * usage: sd_bulk_test <payload file> <frames file>, written by bulk_frames.py
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "test.h"
+#include "sd/sd_bulk_frame.h"
+
+#define BLOCK_SIZE 256 // SD_BULK_BLOCK_SIZE
+
+static uint8_t payload[4096], frames[8192], received[4096];
+static long payload_len, frames_len;
+
+static long load(const char* path, uint8_t* buffer, long size) {
+  FILE* f = fopen(path, "rb");
+  if (!f) { printf("can't open %s\n", path); exit(1); }
+  long n = fread(buffer, 1, size, f);
+  fclose(f);
+  return n;
+}
+
+// Feed bytes until a frame ends, returns the result and moves pos past the bytes used
+static BulkFrameResult next_frame(bulk_frame_t &frame, const uint8_t* stream, long len, long &pos, uint8_t* data, uint16_t max_len) {
+  bulk_frame_start(frame, data, max_len);
+  BulkFrameResult result = BULK_MORE;
+  while (result == BULK_MORE && pos < len) result = bulk_frame_add(frame, stream[pos++]);
+  return result;
+}
+
+int main(int argc, char** argv) {
+  if (argc < 3) { printf("usage: %s <payload> <frames>\n", argv[0]); return 1; }
+  payload_len = load(argv[1], payload, sizeof(payload));
+  frames_len = load(argv[2], frames, sizeof(frames));
+  CHECK(payload_len > 3 * 512);
+
+  // All the frames of the script are good, in order, and give the payload back
+  bulk_frame_t frame;
+  long pos = 0, fill = 0;
+  int count = 0;
+  for (;;) {
+    BulkFrameResult result = next_frame(frame, frames, frames_len, pos, received + fill, BLOCK_SIZE);
+    CHECK_EQ(result, BULK_GOOD);
+    if (result != BULK_GOOD) break;
+    CHECK_EQ(frame.seq, count & 0xFF);
+    count++;
+    fill += frame.len;
+    if (!frame.len) break;
+  }
+  CHECK_EQ(pos, frames_len);
+  CHECK_EQ(fill, payload_len);
+  CHECK(memcmp(received, payload, payload_len) == 0);
+  CHECK_EQ(count, (payload_len + BLOCK_SIZE - 1) / BLOCK_SIZE + 1);
+
+  const long first_len = SD_BULK_FRAME(BLOCK_SIZE);
+
+  // Noise before the sync marker is skipped
+  uint8_t stream[600];
+  memcpy(stream, "\x00\x11\x22", 3);
+  memcpy(stream + 3, frames, first_len);
+  pos = 0;
+  CHECK_EQ(next_frame(frame, stream, 3 + first_len, pos, received, BLOCK_SIZE), BULK_GOOD);
+  CHECK_EQ(pos, 3 + first_len);
+
+  // Every changed bit after the marker makes the frame bad
+  for (long i = 1; i < first_len; i++) {
+    for (int bit = 0; bit < 8; bit++) {
+      memcpy(stream, frames, first_len);
+      stream[i] ^= 1 << bit;
+      pos = 0;
+      BulkFrameResult result = next_frame(frame, stream, first_len, pos, received, BLOCK_SIZE);
+      CHECK(result != BULK_GOOD);
+    }
+  }
+
+  // A frame longer than the room left is refused as soon as its length is known
+  pos = 0;
+  CHECK_EQ(next_frame(frame, frames, frames_len, pos, received, BLOCK_SIZE / 2), BULK_BAD);
+  CHECK_EQ(pos, 4);
+
+  return test_result("sd_bulk");
+}
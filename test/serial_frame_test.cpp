@@ -0,0 +1,96 @@
+/**
+ * Line number and checksum parsing of communication/serial_frame.h against
+ * the way a host frames its lines: "N<n> <command>*<XOR of the bytes before '*'>"
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "test.h"
+#include "communication/serial_frame.h"
+
+// Feed a line the way get_command() does, without the end of line
+static void parse(const char* line) {
+  serial_frame = serial_checksum = 0;
+  serial_param = 0;
+  for (const char* p = line; *p; p++) serial_frame_add(*p);
+  serial_frame_end_param();
+}
+
+static uint8_t host_checksum(const char* line) {
+  uint8_t sum = 0;
+  while (*line == ' ') line++;
+  for (; *line && *line != '*'; line++) sum ^= *line;
+  return sum;
+}
+
+static void check_framed(const char* command, long n) {
+  char line[120];
+  sprintf(line, "N%ld %s", n, command);
+  uint8_t sum = host_checksum(line);
+  sprintf(line + strlen(line), "*%d", sum);
+
+  parse(line);
+  CHECK((serial_frame & (FRAME_N | FRAME_STAR)) == (FRAME_N | FRAME_STAR));
+  CHECK_EQ(serial_line_n, n);
+  CHECK_EQ(serial_checksum, sum);
+  CHECK_EQ(serial_star_value, sum);
+
+  // A changed byte no longer matches
+  char* p = strchr(line, ' ') + 1;
+  *p ^= 1;
+  parse(line);
+  CHECK(serial_checksum != serial_star_value);
+}
+
+int main() {
+  check_framed("G1 X10.5 Y-3 F3000", 0);
+  check_framed("G1 X10.5 Y-3 F3000", 123456);
+  check_framed("M105", 7);
+  check_framed("G7 $1 L68 DAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAA", 42);
+
+  // Random printable commands
+  srand(2);
+  for (int t = 0; t < 2000; t++) {
+    char command[80];
+    int len = 1 + rand() % 70;
+    for (int i = 0; i < len; i++) {
+      char c;
+      do c = ' ' + rand() % 95; while (c == '*' || c == ';');
+      command[i] = c;
+    }
+    command[len] = 0;
+    check_framed(command, rand() % 100000);
+  }
+
+  // Leading spaces are skipped, like the parser does
+  parse("  N5 G28*");
+  CHECK_EQ(serial_line_n, 5);
+  CHECK_EQ(serial_checksum, host_checksum("N5 G28"));
+
+  // M110 sets the line number from its own N
+  char line[40];
+  sprintf(line, "N10 M110 N99*%d", host_checksum("N10 M110 N99"));
+  parse(line);
+  CHECK(serial_frame & FRAME_M110);
+  CHECK(serial_frame & FRAME_M110_N);
+  CHECK_EQ(serial_line_n, 10);
+  CHECK_EQ(serial_m110_n, 99);
+  CHECK_EQ(serial_checksum, serial_star_value);
+
+  parse("M110 N0");
+  CHECK(!(serial_frame & FRAME_N));
+  CHECK(serial_frame & FRAME_M110_N);
+  CHECK_EQ(serial_m110_n, 0);
+
+  // M1100 isn't M110, an N later in the line isn't a line number
+  parse("M1100 N3");
+  CHECK(!(serial_frame & (FRAME_M110 | FRAME_M110_N | FRAME_N)));
+  parse("G1 N3");
+  CHECK(!(serial_frame & FRAME_N));
+
+  // No checksum
+  parse("N3 G1 X1");
+  CHECK(serial_frame & FRAME_N);
+  CHECK(!(serial_frame & FRAME_STAR));
+
+  return test_result("serial_frame");
+}
@@ -0,0 +1,10 @@
+// Host stand-in for avr-libc: flash data is plain memory
+#ifndef STUB_PGMSPACE_H
+#define STUB_PGMSPACE_H
+
+#include <stdint.h>
+
+#define PROGMEM
+#define pgm_read_byte(addr) (*(const uint8_t*)(addr))
+
+#endif
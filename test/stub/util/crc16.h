@@ -0,0 +1,13 @@
+// Host stand-in for avr-libc, the C equivalent given in its documentation
+#ifndef STUB_CRC16_H
+#define STUB_CRC16_H
+
+#include <stdint.h>
+
+static inline uint16_t _crc_xmodem_update(uint16_t crc, uint8_t data) {
+  crc = crc ^ ((uint16_t)data << 8);
+  for (int i = 0; i < 8; i++) crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+  return crc;
+}
+
+#endif
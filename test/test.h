@@ -0,0 +1,32 @@
+/**
+ * Minimal checks for the host tests, see test/Makefile
+ */
+#ifndef TEST_H
+#define TEST_H
+
+#include <stdio.h>
+
+static int test_failures = 0;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+      printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+      test_failures++; \
+    } \
+  } while (0)
+
+#define CHECK_EQ(a, b) do { \
+    long _a = (long)(a), _b = (long)(b); \
+    if (_a != _b) { \
+      printf("%s:%d: CHECK_EQ(%s, %s) failed: %ld != %ld\n", __FILE__, __LINE__, #a, #b, _a, _b); \
+      test_failures++; \
+    } \
+  } while (0)
+
+// Print the result and give main() its exit code
+static int test_result(const char* name) {
+  printf("%s: %s\n", name, test_failures ? "FAILED" : "ok");
+  return test_failures ? 1 : 0;
+}
+
+#endif // TEST_H